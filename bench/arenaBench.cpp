@@ -0,0 +1,113 @@
+// Tick time of the multi-snake arena as the number of snakes grows, on one
+// thread and on the job system, and a check that both end in the same arena.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "core/arena.h"
+#include "core/jobSystem.h"
+
+struct Options
+{
+    ArenaConfig arena;
+    size_t      minSnakes   = 16;
+    size_t      maxSnakes   = 16384;
+    int         ticks       = 1000;
+    int         warmupTicks = 200;  // long enough for snakes to grow and start dying
+    size_t      threads     = 0;    // 0 is every hardware thread
+};
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// seconds per tick over options.ticks after the warmup
+static double TimeTicks(Arena &arena, JobSystem *jobs, const Options &options)
+{
+    for (int tick = 0; tick < options.warmupTicks; tick++) {
+        arena.Step(jobs);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < options.ticks; tick++) {
+        arena.Step(jobs);
+    }
+    return Seconds(start) / options.ticks;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--grid") && hasValue) {
+            int parsed = std::sscanf(argv[++i], "%dx%d", &options.arena.width, &options.arena.height);
+            if (parsed == 1) {
+                options.arena.height = options.arena.width;
+            }
+        } else if (!std::strcmp(argv[i], "--min-snakes") && hasValue) {
+            options.minSnakes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--max-snakes") && hasValue) {
+            options.maxSnakes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--ticks") && hasValue) {
+            options.ticks = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            options.arena.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--threads") && hasValue) {
+            options.threads = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--grid WxH] [--min-snakes N] [--max-snakes N] [--ticks N] [--seed N] [--threads N]"
+                      << "\n";
+            return 1;
+        }
+    }
+    if (std::min(options.arena.width, options.arena.height) < MIN_GRID_SIZE
+        || std::max(options.arena.width, options.arena.height) > MAX_GRID_SIZE) {
+        std::cerr << "--grid must be between " << MIN_GRID_SIZE << " and " << MAX_GRID_SIZE << " cells per side"
+                  << "\n";
+        return 1;
+    }
+    if (options.minSnakes == 0 || options.ticks <= 0) {
+        std::cerr << "--min-snakes and --ticks must be positive" << "\n";
+        return 1;
+    }
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    JobSystem jobs(options.threads);
+    std::cout << "grid: " << options.arena.width << "x" << options.arena.height << ", ticks: " << options.ticks
+              << ", threads: " << jobs.WorkerCount() << "\n";
+
+    // each count doubles the last, with two fruits per snake
+    bool allMatch = true;
+    for (size_t snakes = options.minSnakes; snakes <= options.maxSnakes; snakes *= 2) {
+        options.arena.snakes = snakes;
+        options.arena.fruits = snakes * 2;
+
+        Arena  serial(options.arena);
+        double serialTick = TimeTicks(serial, nullptr, options);
+
+        Arena  parallel(options.arena);
+        double parallelTick = TimeTicks(parallel, &jobs, options);
+
+        bool same = serial.Checksum() == parallel.Checksum();
+        allMatch  = allMatch && same;
+
+        const ArenaStats &stats        = parallel.Stats();
+        double            movesPerTick = static_cast<double>(stats.moves) / parallel.Tick();
+        std::cout << snakes << " snakes: " << serialTick * 1e6 << " us/tick on 1 thread, " << parallelTick * 1e6
+                  << " us/tick on " << jobs.WorkerCount() << ", " << parallelTick * 1e9 / movesPerTick
+                  << " ns per move, " << serialTick / parallelTick << "x, alive " << parallel.Alive()
+                  << ", crashes " << stats.crashes << ", head-on " << stats.headOnDeaths << ", eaten "
+                  << stats.fruitsEaten << (same ? "" : ", ARENAS DIFFER") << "\n";
+    }
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Plays seeded games with the autopilot and reports how fast it decides, how long
+// its snakes get and the slowest single decision, which bounds its per-tick cost.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "core/autopilot.h"
+#include "core/batchSim.h"
+#include "core/gameState.h"
+
+struct Options
+{
+    int      width    = GRID_WIDTH;
+    int      height   = GRID_HEIGHT;
+    size_t   games    = 16;
+    uint64_t maxTicks = 0;  // per game, 0 is the number of cells squared
+    uint64_t seed     = 1;
+    size_t   budget   = Autopilot::DEFAULT_SEARCH_BUDGET;
+};
+
+struct GameResult
+{
+    size_t   length;
+    uint64_t ticks;
+    bool     won;
+    bool     died;
+};
+
+static GameResult PlayGame(const Options &options, uint64_t seed, Autopilot &autopilot, double &slowest)
+{
+    GameState state(options.width, options.height);
+    ResetGame(state, seed);
+    autopilot.Reset();
+    state.snakeDir = Direction::Right;  // as when the player starts the game
+
+    while (!state.gameOver && state.tick < options.maxTicks) {
+        auto      start    = std::chrono::steady_clock::now();
+        Direction decision = autopilot.Decide(state);
+        slowest = std::max(slowest, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        Step(state, decision);
+    }
+    return GameResult{state.snake.Size(), state.tick, state.gameWon, state.gameOver && !state.gameWon};
+}
+
+auto main(int argc, char **argv) -> int
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--grid") && hasValue) {
+            int parsed = std::sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+            if (parsed == 1) {
+                options.height = options.width;
+            }
+        } else if (!std::strcmp(argv[i], "--games") && hasValue) {
+            options.games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--max-ticks") && hasValue) {
+            options.maxTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--budget") && hasValue) {
+            options.budget = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--grid WxH] [--games N] [--max-ticks N] [--seed N] [--budget N]"
+                      << "\n";
+            return 1;
+        }
+    }
+    if (std::min(options.width, options.height) < MIN_GRID_SIZE
+        || std::max(options.width, options.height) > MAX_GRID_SIZE) {
+        std::cerr << "--grid must be between " << MIN_GRID_SIZE << " and " << MAX_GRID_SIZE << " cells per side"
+                  << "\n";
+        return 1;
+    }
+
+    // following a cycle fills the board well within that, a snake chasing its tail
+    // on a board without one may never finish
+    if (options.maxTicks == 0) {
+        uint64_t cells   = static_cast<uint64_t>(options.width) * options.height;
+        options.maxTicks = cells * cells;
+    }
+
+    Autopilot autopilot(options.width, options.height, options.budget);
+    std::cout << "grid: " << options.width << "x" << options.height << ", games: " << options.games
+              << ", search budget: " << options.budget << (autopilot.HasCycle() ? "" : ", no Hamiltonian cycle")
+              << "\n";
+
+    double   totalLength = 0.0;
+    uint64_t totalTicks  = 0;
+    size_t   wins        = 0;
+    size_t   deaths      = 0;
+    double   slowest     = 0.0;
+    auto     start       = std::chrono::steady_clock::now();
+    for (size_t game = 0; game < options.games; game++) {
+        GameResult result = PlayGame(options, BatchSim::EpisodeSeed(options.seed, game, 0), autopilot, slowest);
+        totalLength += static_cast<double>(result.length);
+        totalTicks += result.ticks;
+        wins += result.won;
+        deaths += result.died;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const AutopilotStats &stats = autopilot.Stats();
+    std::cout << "decisions: " << stats.decisions << " in " << elapsed << " s, "
+              << stats.decisions / elapsed / 1e6 << " M/s, slowest: " << slowest * 1e6 << " us" << "\n";
+    std::cout << "avg final length: " << totalLength / options.games << " of " << options.width * options.height
+              << ", won: " << wins << ", died: " << deaths << ", avg ticks: " << totalTicks / options.games << "\n";
+    std::cout << "searches: " << stats.searches << ", avg expansions: "
+              << (stats.searches > 0 ? stats.expansions / stats.searches : 0) << ", cycle moves: " << stats.cycleMoves
+              << ", tail chases: " << stats.tailChases << "\n";
+    // with a cycle the snake can always survive, so a death there is a bug
+    return deaths == 0 || !autopilot.HasCycle() ? 0 : 1;
+}
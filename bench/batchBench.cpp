@@ -0,0 +1,130 @@
+// Throughput of BatchSim against a plain loop over GameState/Step, and a check
+// that both produce the same games from the same seeds and inputs.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "core/batchSim.h"
+#include "core/gameState.h"
+#include "core/rng.h"
+
+const int INPUT_FRAMES = 64;
+
+struct Options
+{
+    size_t   games = 4096;
+    int      steps = 2000;
+    uint64_t seed  = 1;
+};
+
+// mostly keep going, turn now and then, so games last a while
+static std::vector<Direction> MakeInputs(size_t games, uint64_t seed)
+{
+    std::vector<Direction> inputs(games * INPUT_FRAMES);
+    Rng                    rng;
+    rng.Seed(seed, 1);
+    for (Direction &input : inputs) {
+        input = rng.NextBelow(100) < 15 ? static_cast<Direction>(rng.NextBelow(4)) : Direction::None;
+    }
+    return inputs;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double RunScalar(const Options &options, const std::vector<Direction> &inputs, std::vector<GameState> &states)
+{
+    std::vector<uint64_t> episodes(options.games, 0);
+    states.assign(options.games, GameState());
+    for (size_t game = 0; game < options.games; game++) {
+        ResetGame(states[game], BatchSim::EpisodeSeed(options.seed, game, 0));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < options.steps; step++) {
+        const Direction *frame = &inputs[(step % INPUT_FRAMES) * options.games];
+        for (size_t game = 0; game < options.games; game++) {
+            GameState &state = states[game];
+            Step(state, frame[game]);
+            if (state.gameOver) {
+                ResetGame(state, BatchSim::EpisodeSeed(options.seed, game, ++episodes[game]));
+            }
+        }
+    }
+    return Seconds(start);
+}
+
+static double RunBatch(const Options &options, const std::vector<Direction> &inputs, BatchSim &sim)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < options.steps; step++) {
+        sim.Step(&inputs[(step % INPUT_FRAMES) * options.games]);
+    }
+    return Seconds(start);
+}
+
+static size_t CountMatches(const BatchSim &sim, const std::vector<GameState> &states)
+{
+    size_t matches = 0;
+    for (size_t game = 0; game < sim.Size(); game++) {
+        const GameState &state = states[game];
+        bool             same  = sim.Head(game) == state.snake.Head() && sim.Fruit(game) == state.fruit
+                      && sim.Score(game) == state.score && sim.Length(game) == state.snake.Size();
+        for (size_t i = 0; same && i < state.snake.Size(); i++) {
+            same = sim.Segment(game, i) == state.snake[i];
+        }
+        matches += same;
+    }
+    return matches;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) {
+            options.games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--steps") && hasValue) {
+            options.steps = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--games N] [--steps N] [--seed N]" << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Direction> inputs     = MakeInputs(options.games, options.seed);
+    double                 totalSteps = static_cast<double>(options.games) * options.steps;
+
+    std::cout << "games: " << options.games << ", steps: " << options.steps << ", grid: " << GRID_WIDTH << "x"
+              << GRID_HEIGHT << "\n";
+
+    std::vector<GameState> states;
+    double                 scalarTime = RunScalar(options, inputs, states);
+    std::cout << "scalar GameState loop: " << totalSteps / scalarTime / 1e6 << " Msteps/s" << "\n";
+
+    bool allMatch = true;
+    for (BatchKernel kernel : {BatchKernel::Scalar, BatchKernel::Sse2, BatchKernel::Avx2}) {
+        if (!BatchSim::KernelSupported(kernel)) {
+            std::cout << "batch " << BatchSim::KernelName(kernel) << ": not supported" << "\n";
+            continue;
+        }
+
+        BatchSim sim(options.games, options.seed, GRID_WIDTH, GRID_HEIGHT, kernel);
+        double   time    = RunBatch(options, inputs, sim);
+        size_t   matches = CountMatches(sim, states);
+        allMatch         = allMatch && matches == options.games;
+
+        std::cout << "batch " << BatchSim::KernelName(kernel) << ": " << totalSteps / time / 1e6 << " Msteps/s ("
+                  << scalarTime / time << "x), " << matches << "/" << options.games << " games match" << "\n";
+    }
+
+    return allMatch ? 0 : 1;
+}
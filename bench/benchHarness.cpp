@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "benchHarness.h"
+
+// calibration stops doubling here even if a run is still shorter than minTime
+const uint64_t MAX_ITERATIONS = uint64_t(1) << 40;
+
+double BenchResult::Min() const
+{
+    return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double BenchResult::Median() const
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t middle = sorted.size() / 2;
+    return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0;
+}
+
+double BenchResult::Mean() const
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    return sum / samples.size();
+}
+
+double BenchResult::Deviation() const
+{
+    if (samples.size() < 2) {
+        return 0.0;
+    }
+    double mean    = Mean();
+    double squares = 0.0;
+    for (double sample : samples) {
+        squares += (sample - mean) * (sample - mean);
+    }
+    return std::sqrt(squares / (samples.size() - 1));
+}
+
+void BenchSuite::Add(const std::string &name, BenchFunction function, void *context)
+{
+    cases.push_back({name, function, context});
+}
+
+static double TimeRun(BenchFunction function, void *context, uint64_t iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    function(iterations, context);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+BenchResult BenchSuite::Measure(const Case &benchCase, const BenchOptions &options) const
+{
+    // double until a run is long enough, then scale to about minTime
+    uint64_t iterations = 1;
+    double   elapsed    = TimeRun(benchCase.function, benchCase.context, iterations);
+    while (elapsed < options.minTime && iterations < MAX_ITERATIONS) {
+        iterations *= 2;
+        elapsed = TimeRun(benchCase.function, benchCase.context, iterations);
+    }
+    if (elapsed > 0.0) {
+        double scaled = iterations * options.minTime / elapsed;
+        iterations    = std::max<uint64_t>(1, static_cast<uint64_t>(std::min(scaled, double(MAX_ITERATIONS))));
+    }
+
+    BenchResult result;
+    result.name       = benchCase.name;
+    result.iterations = iterations;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+        double seconds = TimeRun(benchCase.function, benchCase.context, iterations);
+        result.samples.push_back(seconds * 1e9 / iterations);
+    }
+    return result;
+}
+
+static void WriteJson(std::ostream &out, const BenchOptions &options, const std::vector<BenchResult> &results)
+{
+#if defined(NDEBUG)
+    const char *build = "release";
+#else
+    const char *build = "debug";
+#endif
+
+    out << "{\n";
+    out << "  \"context\": {\"repetitions\": " << options.repetitions << ", \"min_time\": " << options.minTime
+        << ", \"hardware_threads\": " << std::thread::hardware_concurrency() << ", \"build\": \"" << build << "\"},\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": {\"min\": " << result.Min() << ", \"median\": " << result.Median()
+            << ", \"mean\": " << result.Mean() << ", \"stddev\": " << result.Deviation() << "}, \"samples\": [";
+        for (size_t s = 0; s < result.samples.size(); s++) {
+            out << (s ? ", " : "") << result.samples[s];
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int BenchSuite::Run(const BenchOptions &options)
+{
+    if (options.list) {
+        for (const Case &benchCase : cases) {
+            std::cout << benchCase.name << "\n";
+        }
+        return 0;
+    }
+
+    std::vector<BenchResult> results;
+    char                     line[160];
+    std::snprintf(line, sizeof(line), "%-36s %12s %12s %12s %8s\n", "case", "min ns", "median ns", "mean ns", "cv %");
+    std::cout << line;
+    for (const Case &benchCase : cases) {
+        if (benchCase.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        BenchResult result = Measure(benchCase, options);
+        double      mean   = result.Mean();
+        std::snprintf(line,
+                      sizeof(line),
+                      "%-36s %12.2f %12.2f %12.2f %8.2f\n",
+                      result.name.c_str(),
+                      result.Min(),
+                      result.Median(),
+                      mean,
+                      mean > 0.0 ? result.Deviation() / mean * 100.0 : 0.0);
+        std::cout << line << std::flush;
+        results.push_back(result);
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream file(options.jsonPath);
+        WriteJson(file, options, results);
+        if (!file) {
+            std::cerr << "Failed to write " << options.jsonPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bool ParseBenchOptions(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--list")) {
+            options.list = true;
+        } else if (!std::strcmp(argv[i], "--repetitions") && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--min-time") && hasValue) {
+            options.minTime = std::max(0.0, std::atof(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--filter") && hasValue) {
+            options.filter = argv[++i];
+        } else if (!std::strcmp(argv[i], "--json") && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--repetitions N] [--min-time SECONDS] [--filter TEXT] [--json FILE] [--list]" << "\n";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Small timing harness for chad-bench. A case is a function that runs the
+// operation under test a given number of times. Each case is first calibrated:
+// the count doubles until one run takes minTime. It is then timed for
+// `repetitions` runs of that count and reported as nanoseconds per operation:
+// minimum, median, mean and standard deviation over the repetitions. --json
+// writes the same, with every sample, for comparing runs between commits.
+using BenchFunction = void (*)(uint64_t iterations, void *context);
+
+struct BenchOptions
+{
+    int         repetitions = 10;
+    double      minTime     = 0.05;  // seconds per repetition
+    std::string filter;              // only cases whose name contains this
+    std::string jsonPath;
+    bool        list = false;
+};
+
+struct BenchResult
+{
+    std::string         name;
+    uint64_t            iterations = 0;  // per repetition
+    std::vector<double> samples;         // nanoseconds per operation, one per repetition
+
+    double Min() const;
+    double Median() const;
+    double Mean() const;
+    double Deviation() const;
+};
+
+// keeps value, and everything it was computed from, from being optimized away
+template<typename T>
+inline void DoNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T *sink;
+    sink = &value;
+#endif
+}
+
+class BenchSuite
+{
+public:
+    void Add(const std::string &name, BenchFunction function, void *context);
+
+    // runs the cases that pass the filter in the order they were added, prints a
+    // table and writes JSON when asked; returns the process exit code
+    int Run(const BenchOptions &options);
+
+private:
+    struct Case
+    {
+        std::string   name;
+        BenchFunction function;
+        void         *context;
+    };
+
+    BenchResult Measure(const Case &benchCase, const BenchOptions &options) const;
+
+    std::vector<Case> cases;
+};
+
+// --repetitions N, --min-time SECONDS, --filter TEXT, --json FILE, --list;
+// false after printing usage when an argument is not one of them
+bool ParseBenchOptions(int argc, char **argv, BenchOptions &options);
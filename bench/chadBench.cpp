@@ -0,0 +1,325 @@
+// Microbenchmarks of the work done every tick and every frame: Step() at a range
+// of snake lengths, SpawnFruit() as the board fills up, text layout, the quads of
+// a frame, and a frame's command buffer sorted and played into the recording
+// backend. Run with --json FILE to keep the numbers for comparing against
+// another build.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchHarness.h"
+#include "core/gameState.h"
+#include "core/rng.h"
+#include "renderCommands.h"
+#include "renderRecorder.h"
+#include "sceneQuads.h"
+#include "simulation.h"
+#include "textLayout.h"
+
+const int    STEP_SIDE       = 128;
+const size_t STEP_LENGTHS[]  = {3, 100, 1000, 10000};
+const int    SPAWN_SIDE      = 256;
+const int    SPAWN_FILLS[]   = {0, 50, 90, 99};  // percent of the board under the snake
+const int    FRAME_SIDE      = 128;
+const size_t FRAME_LENGTHS[] = {100, 1000};
+const float  FRAME_ALPHA     = 0.5f;  // halfway between ticks
+const Vec3   TEXT_COLOR(0.9f, 0.9f, 0.9f);
+
+// A Hamiltonian cycle of a board with an even height: along row 0, back and forth
+// over columns 1.. of the rows above, and down column 0 to the start. A snake
+// laid along it and steered by it never dies and, with no fruit, never grows,
+// so every Step() costs the same.
+static std::vector<Vec2i> CombCycle(int width, int height)
+{
+    std::vector<Vec2i> cycle;
+    cycle.reserve(static_cast<size_t>(width) * height);
+    for (int x = 0; x < width; x++) {
+        cycle.push_back(Vec2i(x, 0));
+    }
+    for (int y = 1; y < height; y++) {
+        for (int i = 1; i < width; i++) {
+            cycle.push_back(Vec2i(y % 2 ? width - i : i, y));
+        }
+    }
+    for (int y = height - 1; y > 0; y--) {
+        cycle.push_back(Vec2i(0, y));
+    }
+    return cycle;
+}
+
+static Direction Towards(const Vec2i &from, const Vec2i &to)
+{
+    if (to.x != from.x) {
+        return to.x > from.x ? Direction::Right : Direction::Left;
+    }
+    return to.y > from.y ? Direction::Up : Direction::Down;
+}
+
+struct StepCase
+{
+    StepCase(int side)
+        : state(side, side)
+    {
+    }
+
+    GameState              state;
+    std::vector<Direction> next;  // per cell, the way along the cycle
+};
+
+static void RunStep(uint64_t iterations, void *context)
+{
+    StepCase &bench = *static_cast<StepCase *>(context);
+    for (uint64_t i = 0; i < iterations; i++) {
+        const Vec2i &head = bench.state.snake.Head();
+        Step(bench.state, bench.next[static_cast<size_t>(head.y) * bench.state.width + head.x]);
+    }
+    DoNotOptimize(bench.state.snake.Head());
+}
+
+static std::unique_ptr<StepCase> MakeStepCase(size_t length)
+{
+    auto               bench = std::make_unique<StepCase>(STEP_SIDE);
+    std::vector<Vec2i> cycle = CombCycle(STEP_SIDE, STEP_SIDE);
+
+    bench->next.resize(cycle.size());
+    for (size_t i = 0; i < cycle.size(); i++) {
+        const Vec2i &cell = cycle[i];
+        bench->next[static_cast<size_t>(cell.y) * STEP_SIDE + cell.x] = Towards(cell, cycle[(i + 1) % cycle.size()]);
+    }
+
+    GameState &state = bench->state;
+    ResetGame(state, 1);
+    state.snake.Clear();
+    for (size_t i = 0; i < length; i++) {
+        state.snake.PushHead(cycle[i]);
+    }
+    state.snakeDir = Towards(cycle[length - 2], cycle[length - 1]);
+    state.fruit    = Vec2i(-1, -1);
+    return bench;
+}
+
+static void RunSpawnFruit(uint64_t iterations, void *context)
+{
+    GameState &state = *static_cast<GameState *>(context);
+    for (uint64_t i = 0; i < iterations; i++) {
+        SpawnFruit(state);
+    }
+    DoNotOptimize(state.fruit);
+}
+
+// a board with fill percent of its cells, picked at random, under the snake
+static std::unique_ptr<GameState> MakeSpawnCase(int fill)
+{
+    auto state = std::make_unique<GameState>(SPAWN_SIDE, SPAWN_SIDE);
+    ResetGame(*state, 1);
+    state->snake.Clear();
+
+    std::vector<Vec2i> cells;
+    for (int y = 0; y < SPAWN_SIDE; y++) {
+        for (int x = 0; x < SPAWN_SIDE; x++) {
+            cells.push_back(Vec2i(x, y));
+        }
+    }
+    Rng rng;
+    rng.Seed(2);
+    for (size_t i = cells.size() - 1; i > 0; i--) {
+        std::swap(cells[i], cells[rng.NextBelow(static_cast<uint32_t>(i + 1))]);
+    }
+
+    size_t filled = cells.size() * fill / 100;
+    for (size_t i = 0; i < filled; i++) {
+        state->snake.PushHead(cells[i]);
+    }
+    return state;
+}
+
+struct TextLine
+{
+    const char *text;
+    float       y;
+    float       scale;
+};
+
+struct TextCase
+{
+    std::vector<TextLine>      lines;
+    std::vector<GlyphInstance> glyphs;
+};
+
+static void RunText(uint64_t iterations, void *context)
+{
+    TextCase &bench = *static_cast<TextCase *>(context);
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench.glyphs.clear();
+        for (const TextLine &line : bench.lines) {
+            LayoutText(line.text, 0.0f, line.y, line.scale, TEXT_COLOR, bench.glyphs);
+        }
+        DoNotOptimize(bench.glyphs.data());
+    }
+}
+
+struct FrameCase
+{
+    SimSnapshot                snapshot;
+    CellRange                  visible;
+    bool                       board = false;
+    std::vector<QuadInstance>  quads;
+    std::vector<GlyphInstance> glyphs;
+    char                       score[32];
+};
+
+static void RunFrame(uint64_t iterations, void *context)
+{
+    FrameCase &bench = *static_cast<FrameCase *>(context);
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench.quads.clear();
+        if (bench.board) {
+            AppendBoardQuads(bench.visible, FRAME_SIDE, FRAME_SIDE, bench.quads);
+        }
+        if (!bench.snapshot.snake.Empty()) {
+            AppendSnakeQuads(bench.snapshot, bench.visible, FRAME_ALPHA, bench.quads);
+        }
+        bench.glyphs.clear();
+        if (bench.score[0]) {
+            LayoutText(bench.score, 0.0f, 0.9f, 0.02f, TEXT_COLOR, bench.glyphs);
+        }
+        DoNotOptimize(bench.quads.data());
+        DoNotOptimize(bench.glyphs.data());
+    }
+}
+
+// the whole board in view, with a snake of length along the comb cycle caught
+// halfway through a tick
+static std::unique_ptr<FrameCase> MakeFrameCase(bool board, size_t length, bool score)
+{
+    auto bench          = std::make_unique<FrameCase>();
+    bench->board        = board;
+    bench->visible.minX = -1;
+    bench->visible.minY = -1;
+    bench->visible.maxX = FRAME_SIDE;
+    bench->visible.maxY = FRAME_SIDE;
+    bench->score[0]     = '\0';
+    if (score) {
+        std::snprintf(bench->score, sizeof(bench->score), "SCORE: %d", static_cast<int>(length) * 10);
+    }
+
+    std::vector<Vec2i> cycle = CombCycle(FRAME_SIDE, FRAME_SIDE);
+    for (size_t i = 0; i < length; i++) {
+        bench->snapshot.snake.PushHead(cycle[i + 1]);
+    }
+    bench->snapshot.moved        = true;
+    bench->snapshot.previousTail = cycle[0];
+    bench->snapshot.fruit        = cycle[length + 10];
+    return bench;
+}
+
+struct RenderCase
+{
+    std::unique_ptr<FrameCase> frame;
+    RenderCommandBuffer        commands;
+    RenderRecorder             recorder;
+};
+
+// a whole in-game frame as the game builds it: the retained board drawn as is,
+// the snake, the score and the HUD, then sorted and recorded
+static void RunRender(uint64_t iterations, void *context)
+{
+    RenderCase &bench = *static_cast<RenderCase *>(context);
+    FrameCase  &frame = *bench.frame;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench.commands.Reset();
+        bench.commands.AddClear(Vec3(0.08f, 0.1f, 0.12f));
+        bench.commands.AddRetainedQuads(RenderLayer::Board, 0, false);
+
+        size_t first = bench.commands.Quads().size();
+        AppendSnakeQuads(frame.snapshot, frame.visible, FRAME_ALPHA, bench.commands.Quads());
+        bench.commands.AddQuads(RenderLayer::Cells, first);
+
+        bench.commands.AddText(frame.score, 0.0f, 0.9f, 0.02f, TEXT_COLOR);
+        bench.commands.AddText("FRAME P50 16.67 P95 16.80 P99 17.10 MAX 18.02 MS", 0.0f, -0.89f, 0.006f, TEXT_COLOR);
+        bench.commands.AddText("CPU 0.42 MS  GPU 0.31 MS  INPUT 21.30 MS", 0.0f, -0.93f, 0.006f, TEXT_COLOR);
+
+        bench.commands.Sort();
+        bench.recorder.Execute(bench.commands);
+        bench.recorder.ClearLog();
+    }
+    DoNotOptimize(bench.recorder.Totals().drawCalls);
+}
+
+static std::unique_ptr<RenderCase> MakeRenderCase(bool serialize)
+{
+    auto bench   = std::make_unique<RenderCase>();
+    bench->frame = MakeFrameCase(false, FRAME_LENGTHS[1], true);
+    bench->recorder.SetSerialize(serialize);
+
+    // the board layer was built on an earlier frame
+    bench->commands.Reset();
+    AppendBoardQuads(bench->frame->visible, FRAME_SIDE, FRAME_SIDE, bench->commands.Quads());
+    bench->commands.AddRetainedQuads(RenderLayer::Board, 0, true);
+    bench->commands.Sort();
+    bench->recorder.Execute(bench->commands);
+    return bench;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    BenchOptions options;
+    if (!ParseBenchOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    BenchSuite suite;
+    char       name[64];
+
+    std::vector<std::unique_ptr<StepCase>> stepCases;
+    for (size_t length : STEP_LENGTHS) {
+        stepCases.push_back(MakeStepCase(length));
+        std::snprintf(name, sizeof(name), "step/length:%zu", length);
+        suite.Add(name, RunStep, stepCases.back().get());
+    }
+
+    std::vector<std::unique_ptr<GameState>> spawnCases;
+    for (int fill : SPAWN_FILLS) {
+        spawnCases.push_back(MakeSpawnCase(fill));
+        std::snprintf(name, sizeof(name), "spawnFruit/fill:%d", fill);
+        suite.Add(name, RunSpawnFruit, spawnCases.back().get());
+    }
+
+    // the lines of the screens that draw text every frame
+    TextCase scoreText;
+    scoreText.lines = {{"SCORE: 1230", 0.9f, 0.02f}};
+    TextCase hudText;
+    hudText.lines = {{"FRAME P50 16.67 P95 16.80 P99 17.10 MAX 18.02 MS", -0.89f, 0.006f},
+                     {"CPU 0.42 MS  GPU 0.31 MS  INPUT 21.30 MS", -0.93f, 0.006f},
+                     {"DRAWS 3  QUADS 412  UNIFORMS 4  STALL 0.00 MS", -0.97f, 0.006f}};
+    TextCase startText;
+    startText.lines = {{"CHAD SNAKE", 0.3f, 0.025f},
+                       {"USE ARROW KEYS TO MOVE", 0.0f, 0.012f},
+                       {"EAT THE RED FRUIT TO GROW", -0.1f, 0.012f},
+                       {"AVOID WALLS AND YOURSELF", -0.2f, 0.012f},
+                       {"PRESS ANY KEY TO START", -0.4f, 0.012f}};
+    suite.Add("text/layout:score", RunText, &scoreText);
+    suite.Add("text/layout:hud", RunText, &hudText);
+    suite.Add("text/layout:start-screen", RunText, &startText);
+
+    std::vector<std::unique_ptr<FrameCase>> frameCases;
+    frameCases.push_back(MakeFrameCase(true, 0, false));
+    suite.Add("frame/board", RunFrame, frameCases.back().get());
+    for (size_t length : FRAME_LENGTHS) {
+        frameCases.push_back(MakeFrameCase(false, length, false));
+        std::snprintf(name, sizeof(name), "frame/snake:length:%zu", length);
+        suite.Add(name, RunFrame, frameCases.back().get());
+    }
+    frameCases.push_back(MakeFrameCase(true, FRAME_LENGTHS[1], true));
+    suite.Add("frame/full", RunFrame, frameCases.back().get());
+
+    std::unique_ptr<RenderCase> recorded   = MakeRenderCase(false);
+    std::unique_ptr<RenderCase> serialized = MakeRenderCase(true);
+    suite.Add("render/record", RunRender, recorded.get());
+    suite.Add("render/serialize", RunRender, serialized.get());
+
+    return suite.Run(options);
+}
@@ -0,0 +1,125 @@
+// Scaling of the job system: plays the same seeded batch of games on 1, 2, 4, ...
+// threads, reports games per second and the speedup over one thread, and checks
+// every thread count produces the same totals. Also times empty jobs, which is
+// the scheduling overhead a game has to amortize.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "core/batchRunner.h"
+#include "core/jobSystem.h"
+
+const size_t EMPTY_JOBS = 1 << 20;
+
+struct Options
+{
+    BatchRunConfig run;
+    size_t         maxThreads = 0;  // 0 is every hardware thread
+};
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool SameTotals(const BatchRunStats &a, const BatchRunStats &b)
+{
+    return a.games == b.games && a.wins == b.wins && a.deaths == b.deaths && a.ticks == b.ticks
+        && a.lengthSum == b.lengthSum && a.scoreSum == b.scoreSum && a.scoreSquares == b.scoreSquares
+        && a.bestScore == b.bestScore && a.worstScore == b.worstScore;
+}
+
+static void Nothing(size_t, size_t, void *) {}
+
+auto main(int argc, char **argv) -> int
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) {
+            options.run.games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--grid") && hasValue) {
+            int parsed = std::sscanf(argv[++i], "%dx%d", &options.run.width, &options.run.height);
+            if (parsed == 1) {
+                options.run.height = options.run.width;
+            }
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            options.run.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--max-ticks") && hasValue) {
+            options.run.maxTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--threads") && hasValue) {
+            options.maxThreads = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--policy") && hasValue && !std::strcmp(argv[i + 1], "autopilot")) {
+            options.run.policy = BatchPolicy::Autopilot;
+            i++;
+        } else if (!std::strcmp(argv[i], "--policy") && hasValue && !std::strcmp(argv[i + 1], "random")) {
+            options.run.policy = BatchPolicy::Random;
+            i++;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--games N] [--grid WxH] [--seed N] [--max-ticks N] [--threads N]"
+                      << " [--policy autopilot|random]" << "\n";
+            return 1;
+        }
+    }
+    if (std::min(options.run.width, options.run.height) < MIN_GRID_SIZE
+        || std::max(options.run.width, options.run.height) > MAX_GRID_SIZE) {
+        std::cerr << "--grid must be between " << MIN_GRID_SIZE << " and " << MAX_GRID_SIZE << " cells per side"
+                  << "\n";
+        return 1;
+    }
+    if (options.maxThreads == 0) {
+        options.maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // 1, 2, 4, ... and the maximum itself when it is not a power of two
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < options.maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(options.maxThreads);
+
+    std::cout << "games: " << options.run.games << ", grid: " << options.run.width << "x" << options.run.height
+              << ", policy: " << (options.run.policy == BatchPolicy::Autopilot ? "autopilot" : "random")
+              << ", hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+    BatchRunStats reference;
+    double        baseRate = 0.0;
+    bool          allMatch = true;
+    for (size_t threads : threadCounts) {
+        JobSystem jobs(threads);
+
+        auto          start   = std::chrono::steady_clock::now();
+        BatchRunStats stats   = RunBatchGames(jobs, options.run);
+        double        elapsed = Seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        jobs.ParallelFor(EMPTY_JOBS, 1, Nothing, nullptr);
+        double emptyJob = Seconds(start) / EMPTY_JOBS;
+
+        double rate = options.run.games / elapsed;
+        if (threads == 1) {
+            reference = stats;
+            baseRate  = rate;
+        }
+        bool same = SameTotals(stats, reference);
+        allMatch  = allMatch && same;
+
+        std::cout << threads << " threads: " << rate << " games/s, " << stats.ticks / elapsed / 1e6 << " Mticks/s, "
+                  << rate / baseRate << "x, efficiency " << rate / baseRate / threads * 100.0 << "%, empty job "
+                  << emptyJob * 1e9 << " ns" << (same ? "" : ", TOTALS DIFFER") << "\n";
+    }
+
+    std::cout << "score: mean " << reference.MeanScore() << ", deviation " << reference.ScoreDeviation() << ", best "
+              << reference.bestScore << ", worst " << reference.worstScore << "\n";
+    std::cout << "length: mean " << reference.MeanLength() << ", won: " << reference.wins
+              << ", died: " << reference.deaths
+              << ", avg ticks: " << (reference.games > 0 ? reference.ticks / reference.games : 0) << "\n";
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+// Rollback costs for two-player versus: saving and restoring a VersusState,
+// simulating again 1 to MAX_ROLLBACK ticks as when a late input arrives, and a
+// match between two RollbackSessions over LoopbackLinks with delay and jitter,
+// and another with more jitter than delay, checking both peers end up in the
+// same state.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include "core/batchRunner.h"
+#include "core/rollback.h"
+#include "core/versus.h"
+
+const int    COPY_REPS      = 1 << 20;
+const int    RESIM_REPS     = 20000;
+const int    WARMUP_TICKS   = 200;
+const double FRAME_TIME     = 1.0 / 60.0;  // one tick per frame
+const size_t SAVED_STATES   = 8;
+const int    RESIM_DEPTHS[] = {1, 2, 4, 8, 10, 12, 16};
+
+// a second match always runs on a link whose jitter exceeds its delay, which
+// reorders inputs and lets one peer confirm ticks it has not simulated yet
+const double JITTERY_DELAY  = 0.05;
+const double JITTERY_JITTER = 0.15;
+
+// keeps the restores from being optimized away
+static volatile uint64_t sink;
+
+struct Options
+{
+    int      width  = GRID_WIDTH;
+    int      height = GRID_HEIGHT;
+    int      frames = 60 * 60;
+    double   delay  = 0.1;   // seconds one way
+    double   jitter = 0.03;  // seconds either side of delay
+    uint64_t seed   = 1;
+};
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the batch runner's random policy, which turns often enough to get a fair share
+// of the turns mispredicted
+static Direction BotInput(const VersusState &state, int player, Rng &rng)
+{
+    auto blocked = [&state, player](Direction direction) { return VersusBlocked(state, player, direction); };
+    return RandomPolicyInput(state.snakes[player].direction, rng, blocked);
+}
+
+static void MeasureCopies(const Options &options)
+{
+    std::unique_ptr<VersusState[]> saved(new VersusState[SAVED_STATES]);
+    VersusState                    state;
+    ResetVersus(state, options.width, options.height, options.seed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < COPY_REPS; i++) {
+        state.tick++;
+        saved[i % SAVED_STATES] = state;
+    }
+    double save = Seconds(start) / COPY_REPS;
+
+    uint64_t sum = 0;
+    start        = std::chrono::steady_clock::now();
+    for (int i = 0; i < COPY_REPS; i++) {
+        state = saved[i % SAVED_STATES];
+        sum += state.tick;
+    }
+    double restore = Seconds(start) / COPY_REPS;
+
+    sink = sum;
+
+    std::cout << "state: " << sizeof(VersusState) << " bytes, save " << save * 1e9 << " ns, restore "
+              << restore * 1e9 << " ns" << "\n";
+}
+
+static void MeasureResimulation(const Options &options)
+{
+    auto session = std::make_unique<RollbackSession>(options.width, options.height, options.seed, 0);
+    Rng  rng[VERSUS_PLAYERS];
+    rng[0].Seed(options.seed, 1);
+    rng[1].Seed(options.seed, 2);
+    for (int tick = 0; tick < WARMUP_TICKS; tick++) {
+        session->ReceiveRemote(session->Tick(), BotInput(session->State(), 1, rng[1]));
+        session->Advance(BotInput(session->State(), 0, rng[0]));
+    }
+
+    for (int depth : RESIM_DEPTHS) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RESIM_REPS; i++) {
+            session->Resimulate(session->Tick() - depth);
+        }
+        double rollback = Seconds(start) / RESIM_REPS;
+        std::cout << "rollback " << depth << " ticks: " << rollback * 1e6 << " us, " << rollback * 1e9 / depth
+                  << " ns per tick, " << rollback / FRAME_TIME * 100.0 << "% of a 60 Hz frame" << "\n";
+    }
+}
+
+// Two peers in one process, each advancing one tick per frame when its window
+// allows and sending its input to the other. Returns false when they disagree.
+static bool PlayMatch(const Options &options)
+{
+    std::unique_ptr<RollbackSession> peers[VERSUS_PLAYERS] = {
+        std::make_unique<RollbackSession>(options.width, options.height, options.seed, 0),
+        std::make_unique<RollbackSession>(options.width, options.height, options.seed, 1)};
+    LoopbackLink links[VERSUS_PLAYERS] = {LoopbackLink(options.delay, options.jitter, options.seed),
+                                          LoopbackLink(options.delay, options.jitter, options.seed + 1)};
+    Rng          rng[VERSUS_PLAYERS];
+    rng[0].Seed(options.seed, 1);
+    rng[1].Seed(options.seed, 2);
+
+    uint64_t stalls     = 0;
+    uint64_t advances   = 0;
+    double   frameTotal = 0.0;
+    double   frameWorst = 0.0;
+    double   now        = 0.0;
+
+    // links[p] carries what peer p sends
+    auto deliver = [&](int player) {
+        LinkMessage message;
+        while (links[1 - player].Receive(now, message)) {
+            peers[player]->ReceiveRemote(message.tick, message.input);
+        }
+    };
+    auto advance = [&](int player, Direction input) {
+        peers[player]->Advance(input);
+        links[player].Send(now, {peers[player]->Tick() - 1, input});
+    };
+
+    for (int frame = 0; frame < options.frames; frame++, now += FRAME_TIME) {
+        for (int player = 0; player < VERSUS_PLAYERS; player++) {
+            deliver(player);
+            if (!peers[player]->CanAdvance()) {
+                stalls++;
+                continue;
+            }
+
+            Direction input = BotInput(peers[player]->State(), player, rng[player]);
+            auto      start = std::chrono::steady_clock::now();
+            advance(player, input);
+            double elapsed = Seconds(start);
+            frameTotal += elapsed;
+            frameWorst = std::max(frameWorst, elapsed);
+            advances++;
+        }
+    }
+
+    // bring the peer that fell behind up to the other and let everything arrive
+    uint64_t last = std::max(peers[0]->Tick(), peers[1]->Tick());
+    while (peers[0]->Tick() < last || peers[1]->Tick() < last || links[0].InFlight() > 0 || links[1].InFlight() > 0) {
+        for (int player = 0; player < VERSUS_PLAYERS; player++) {
+            deliver(player);
+            if (peers[player]->Tick() < last && peers[player]->CanAdvance()) {
+                advance(player, Direction::None);
+            }
+        }
+        now += FRAME_TIME;
+    }
+
+    uint64_t checksums[VERSUS_PLAYERS];
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        peers[player]->Synchronize();
+        checksums[player] = VersusChecksum(peers[player]->State());
+
+        const RollbackStats &stats = peers[player]->Stats();
+        std::cout << "peer " << player << ": " << peers[player]->Tick() << " ticks, " << stats.rollbacks
+                  << " rollbacks, " << (stats.rollbacks > 0 ? double(stats.resimulatedTicks) / stats.rollbacks : 0.0)
+                  << " ticks deep on average, deepest " << stats.deepestRollback << ", " << stats.mispredictions
+                  << " mispredicted inputs" << "\n";
+    }
+
+    const VersusState &state = peers[0]->State();
+    std::cout << "match: " << options.frames << " frames, delay " << options.delay * 1000.0 << " ms, jitter "
+              << options.jitter * 1000.0 << " ms, " << stalls << " stalled frames, rounds " << state.round
+              << ", wins " << state.wins[0] << ":" << state.wins[1] << "\n";
+    std::cout << "advance with rollback: mean " << frameTotal / std::max<uint64_t>(advances, 1) * 1e6 << " us, worst "
+              << frameWorst * 1e6 << " us per frame" << "\n";
+
+    bool same = checksums[0] == checksums[1];
+    if (!same) {
+        std::cout << "PEERS DIFFER" << "\n";
+    }
+    return same;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--grid") && hasValue) {
+            int parsed = std::sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+            if (parsed == 1) {
+                options.height = options.width;
+            }
+        } else if (!std::strcmp(argv[i], "--frames") && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--delay") && hasValue) {
+            options.delay = std::atof(argv[++i]) / 1000.0;
+        } else if (!std::strcmp(argv[i], "--jitter") && hasValue) {
+            options.jitter = std::atof(argv[++i]) / 1000.0;
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--grid WxH] [--frames N] [--delay MS] [--jitter MS] [--seed N]"
+                      << "\n";
+            return 1;
+        }
+    }
+    if (std::min(options.width, options.height) < MIN_GRID_SIZE
+        || std::max(options.width, options.height) > VERSUS_MAX_SIDE) {
+        std::cerr << "--grid must be between " << MIN_GRID_SIZE << " and " << VERSUS_MAX_SIDE << " cells per side"
+                  << "\n";
+        return 1;
+    }
+
+    MeasureCopies(options);
+    MeasureResimulation(options);
+
+    Options jittery = options;
+    jittery.delay   = JITTERY_DELAY;
+    jittery.jitter  = JITTERY_JITTER;
+
+    bool same = PlayMatch(options);
+    same &= PlayMatch(jittery);
+    return same ? 0 : 1;
+}
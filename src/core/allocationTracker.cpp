@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "core/allocationTracker.h"
+
+// plain data, so it is usable from operator new before and after the thread's
+// other thread_locals are constructed
+static thread_local AllocationCounts threadCounts;
+
+static std::atomic<uint64_t> totalAllocations{0};
+static std::atomic<uint64_t> totalFrees{0};
+static std::atomic<uint64_t> totalBytes{0};
+
+AllocationCounts ThreadAllocations()
+{
+    return threadCounts;
+}
+
+AllocationCounts TotalAllocations()
+{
+    AllocationCounts counts;
+    counts.allocations = totalAllocations.load(std::memory_order_relaxed);
+    counts.frees       = totalFrees.load(std::memory_order_relaxed);
+    counts.bytes       = totalBytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+static void CountAllocation(std::size_t size)
+{
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static void CountFree()
+{
+    threadCounts.frees++;
+    totalFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void *Allocate(std::size_t size)
+{
+    CountAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+static void *AllocateAligned(std::size_t size, std::size_t alignment)
+{
+    CountAllocation(size);
+#if defined(_WIN32)
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    void *memory = nullptr;
+    if (posix_memalign(&memory, std::max(alignment, sizeof(void *)), size ? size : 1) != 0) {
+        return nullptr;
+    }
+    return memory;
+#endif
+}
+
+static void Free(void *memory)
+{
+    if (memory) {
+        CountFree();
+        std::free(memory);
+    }
+}
+
+static void FreeAligned(void *memory)
+{
+    if (memory) {
+        CountFree();
+#if defined(_WIN32)
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *memory = Allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *memory = AllocateAligned(size, static_cast<std::size_t>(alignment))) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return AllocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return AllocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    Free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    Free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    Free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+    FreeAligned(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    FreeAligned(memory);
+}
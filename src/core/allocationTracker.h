@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+struct AllocationCounts
+{
+    uint64_t allocations = 0;
+    uint64_t frees       = 0;
+    uint64_t bytes       = 0;  // requested by the allocations, frees do not know their size
+};
+
+// Counts every call to the global operator new and delete. allocationTracker.cpp
+// replaces them with versions that bump a counter and call malloc/free. It is the
+// chad-allocation-tracker object library rather than part of chad-core, so only a
+// program that links it is tracked, and then from the start.
+// Counting is a thread-local increment and a relaxed atomic add per call.
+
+// made by the calling thread so far
+AllocationCounts ThreadAllocations();
+
+// made by all threads so far
+AllocationCounts TotalAllocations();
+
+// what the calling thread allocates between construction and the call, e.g.
+// around frames that are expected not to allocate
+class AllocationScope
+{
+public:
+    AllocationScope()
+        : start(ThreadAllocations())
+    {
+    }
+
+    uint64_t Allocations() const { return ThreadAllocations().allocations - start.allocations; }
+    uint64_t Bytes() const { return ThreadAllocations().bytes - start.bytes; }
+
+private:
+    AllocationCounts start;
+};
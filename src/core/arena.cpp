@@ -0,0 +1,274 @@
+#include <algorithm>
+
+#include "core/arena.h"
+#include "core/batchSim.h"
+#include "core/jobSystem.h"
+
+static const size_t INITIAL_RING = 16;
+
+Arena::Arena(const ArenaConfig &arenaConfig)
+    : config(arenaConfig)
+    , width(arenaConfig.width)
+    , height(arenaConfig.height)
+    , snakes(arenaConfig.snakes)
+    , cells(static_cast<size_t>(arenaConfig.width) * arenaConfig.height, CELL_EMPTY)
+    , claims(new std::atomic<uint8_t>[static_cast<size_t>(arenaConfig.width) * arenaConfig.height]())
+    , occupancy(arenaConfig.width, arenaConfig.height)
+{
+    for (ArenaSnake &snake : snakes) {
+        snake.ring.resize(INITIAL_RING);
+    }
+    Reset();
+}
+
+void Arena::Reset()
+{
+    // clear what is on the board rather than all of it, like SnakeBody::Clear()
+    for (ArenaSnake &snake : snakes) {
+        if (snake.alive) {
+            Kill(snake);
+        }
+    }
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (cells[i] == CELL_FRUIT) {
+            cells[i] = CELL_EMPTY;
+            occupancy.Clear(Vec2i(static_cast<int>(i % width), static_cast<int>(i / width)));
+        }
+    }
+
+    tick   = 0;
+    fruits = 0;
+    stats  = ArenaStats();
+    rng.Seed(config.seed);
+
+    for (size_t i = 0; i < snakes.size(); i++) {
+        ArenaSnake &snake = snakes[i];
+        snake.rng.Seed(BatchSim::EpisodeSeed(config.seed, i, 0), 1);
+        snake.score = 0;
+        Spawn(snake);
+    }
+    while (fruits < config.fruits && occupancy.FreeCount() > 0) {
+        SpawnFruit();
+    }
+}
+
+void Arena::Step(JobSystem *jobs)
+{
+    if (jobs) {
+        jobs->ParallelFor(snakes.size(), PASS_GRAIN, DecidePass, this);
+        jobs->ParallelFor(snakes.size(), PASS_GRAIN, ResolvePass, this);
+    } else {
+        DecidePass(0, snakes.size(), this);
+        ResolvePass(0, snakes.size(), this);
+    }
+    Apply();
+}
+
+uint64_t Arena::Checksum() const
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto     mix  = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+
+    mix(tick);
+    for (const ArenaSnake &snake : snakes) {
+        mix(snake.alive);
+        mix(static_cast<uint64_t>(snake.score));
+        for (size_t i = 0; snake.alive && i < snake.Size(); i++) {
+            mix(CellIndex(snake[i]));
+        }
+    }
+    for (uint8_t cell : cells) {
+        mix(cell);
+    }
+    return hash;
+}
+
+// Scores the three ways that do not reverse: free cells ahead and around them,
+// fruit, keeping the heading, and a little noise so bots do not move in lockstep.
+// Reads the board only, the moves of others this tick are not known yet.
+void Arena::Decide(ArenaSnake &snake)
+{
+    Direction best      = snake.direction;
+    int       bestScore = -1;
+    for (int d = 0; d < 4; d++) {
+        Direction direction = static_cast<Direction>(d);
+        if (snake.Size() > 1 && direction == Reverse(snake.direction)) {
+            continue;
+        }
+
+        Vec2i next = Neighbour(snake.Head(), direction);
+        if (!InBounds(next) || cells[CellIndex(next)] == CELL_BODY) {
+            continue;
+        }
+
+        int score = static_cast<int>(snake.rng.NextBelow(4));
+        score += cells[CellIndex(next)] == CELL_FRUIT ? 16 : 0;
+        score += direction == snake.direction ? 2 : 0;
+        for (int e = 0; e < 4; e++) {
+            Vec2i around = Neighbour(next, static_cast<Direction>(e));
+            if (InBounds(around)) {
+                uint8_t cell = cells[CellIndex(around)];
+                score += cell == CELL_EMPTY ? 3 : cell == CELL_FRUIT ? 6 : 0;
+            }
+        }
+
+        if (score > bestScore) {
+            best      = direction;
+            bestScore = score;
+        }
+    }
+
+    snake.direction = best;
+    snake.target    = Neighbour(snake.Head(), best);
+    snake.blocked   = bestScore < 0;
+    snake.headOn    = false;
+    if (!snake.blocked) {
+        claims[CellIndex(snake.target)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Arena::DecidePass(size_t begin, size_t end, void *context)
+{
+    Arena &arena = *static_cast<Arena *>(context);
+    for (size_t i = begin; i < end; i++) {
+        if (arena.snakes[i].alive) {
+            arena.Decide(arena.snakes[i]);
+        }
+    }
+}
+
+// every claim is in once the decide pass has finished
+void Arena::ResolvePass(size_t begin, size_t end, void *context)
+{
+    Arena &arena = *static_cast<Arena *>(context);
+    for (size_t i = begin; i < end; i++) {
+        ArenaSnake &snake = arena.snakes[i];
+        if (snake.alive && !snake.blocked) {
+            snake.headOn = arena.claims[arena.CellIndex(snake.target)].load(std::memory_order_relaxed) > 1;
+        }
+    }
+}
+
+// Deaths first, which frees no cell a survivor moves onto since those were all
+// free before the tick, then the moves, then new fruit and respawns on whatever
+// is free after them.
+void Arena::Apply()
+{
+    tick++;
+
+    for (ArenaSnake &snake : snakes) {
+        if (!snake.alive) {
+            continue;
+        }
+        if (!snake.blocked) {
+            claims[CellIndex(snake.target)].store(0, std::memory_order_relaxed);
+        }
+        if (snake.blocked || snake.headOn) {
+            stats.crashes += snake.blocked;
+            stats.headOnDeaths += snake.headOn;
+            Kill(snake);
+        }
+    }
+
+    for (ArenaSnake &snake : snakes) {
+        if (!snake.alive) {
+            continue;
+        }
+        stats.moves++;
+
+        size_t target = CellIndex(snake.target);
+        if (cells[target] == CELL_FRUIT) {
+            cells[target] = CELL_EMPTY;
+            occupancy.Clear(snake.target);
+            fruits--;
+            snake.score += 10;
+            snake.growth++;
+            stats.fruitsEaten++;
+        }
+
+        // the tail goes first so a plain move never finds the ring full
+        if (snake.growth > 0) {
+            snake.growth--;
+        } else {
+            PopTail(snake);
+        }
+        PushHead(snake, snake.target);
+    }
+
+    while (fruits < config.fruits && occupancy.FreeCount() > 0) {
+        SpawnFruit();
+    }
+    for (ArenaSnake &snake : snakes) {
+        if (!snake.alive && tick >= snake.respawnAt) {
+            Spawn(snake);
+        }
+    }
+}
+
+void Arena::Kill(ArenaSnake &snake)
+{
+    while (snake.count > 0) {
+        PopTail(snake);
+    }
+    snake.alive     = false;
+    snake.respawnAt = tick + config.respawnTicks;
+    alive--;
+}
+
+// one cell anywhere free, growing into startLength over the next ticks; stays
+// dead until the next tick when the board is full
+void Arena::Spawn(ArenaSnake &snake)
+{
+    if (occupancy.FreeCount() == 0) {
+        return;
+    }
+
+    uint32_t slot = rng.NextBelow(static_cast<uint32_t>(occupancy.FreeCount()));
+    snake.head    = 0;
+    snake.count   = 0;
+    PushHead(snake, occupancy.NthFree(slot));
+    snake.direction = static_cast<Direction>(snake.rng.NextBelow(4));
+    snake.growth    = static_cast<uint32_t>(std::max(config.startLength - 1, 0));
+    snake.alive     = true;
+    stats.respawns += tick > 0;
+    alive++;
+}
+
+void Arena::SpawnFruit()
+{
+    uint32_t slot          = rng.NextBelow(static_cast<uint32_t>(occupancy.FreeCount()));
+    Vec2i    cell          = occupancy.NthFree(slot);
+    cells[CellIndex(cell)] = CELL_FRUIT;
+    occupancy.Set(cell);
+    fruits++;
+}
+
+void Arena::PushHead(ArenaSnake &snake, const Vec2i &cell)
+{
+    if (snake.count == snake.ring.size()) {
+        // doubles the ring, keeping the segments in order
+        std::vector<Vec2i> grown(snake.ring.size() * 2);
+        for (size_t i = 0; i < snake.count; i++) {
+            grown[i] = snake[i];
+        }
+        snake.ring.swap(grown);
+        snake.head = 0;
+    }
+
+    snake.head             = (snake.head - 1) & (snake.ring.size() - 1);
+    snake.ring[snake.head] = cell;
+    snake.count++;
+    cells[CellIndex(cell)] = CELL_BODY;
+    occupancy.Set(cell);
+}
+
+void Arena::PopTail(ArenaSnake &snake)
+{
+    const Vec2i &tail      = snake.Tail();
+    cells[CellIndex(tail)] = CELL_EMPTY;
+    occupancy.Clear(tail);
+    snake.count--;
+}
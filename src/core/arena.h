@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/gameState.h"
+#include "core/occupancyGrid.h"
+#include "core/rng.h"
+#include "core/vec.h"
+
+class JobSystem;
+
+struct ArenaConfig
+{
+    int      width        = 512;
+    int      height       = 512;
+    size_t   snakes       = 256;
+    size_t   fruits       = 512;  // kept on the board, each one eaten is replaced
+    uint64_t seed         = 1;
+    int      startLength  = 4;   // a new snake starts as one cell and grows into this
+    uint64_t respawnTicks = 20;  // a dead snake comes back this many ticks later
+};
+
+// One bot in the arena. The body is a ring of segments, head first, like
+// SnakeBody but without an occupancy grid of its own: the arena keeps one for all.
+struct ArenaSnake
+{
+    // segment i counted from the head
+    const Vec2i &operator[](size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    const Vec2i &Head() const { return ring[head]; }
+
+    const Vec2i &Tail() const { return (*this)[count - 1]; }
+
+    size_t Size() const { return count; }
+
+    std::vector<Vec2i> ring;  // power-of-two size
+    size_t             head      = 0;
+    size_t             count     = 0;
+    Direction          direction = Direction::None;
+    uint32_t           growth    = 0;  // ticks left on which the tail stays put
+    bool               alive     = false;
+    uint64_t           respawnAt = 0;
+    int                score     = 0;
+    Rng                rng;  // the bot's own, so deciding in parallel stays deterministic
+
+    // this tick's move, filled in by the decide and resolve passes
+    Vec2i target;
+    bool  blocked = false;  // wall or body ahead
+    bool  headOn  = false;  // another head moves onto target too
+};
+
+struct ArenaStats
+{
+    uint64_t moves        = 0;  // snake-ticks of living snakes
+    uint64_t fruitsEaten  = 0;
+    uint64_t crashes      = 0;  // into a wall or a body
+    uint64_t headOnDeaths = 0;  // two or more heads onto the same cell
+    uint64_t respawns     = 0;
+};
+
+// Many bot snakes and fruits on one board. Cells are looked up by index in grids
+// shared by every snake: what is on a cell (body or fruit), and how many heads
+// want to move onto it this tick, so a head's collisions cost O(1) however many
+// snakes there are and however long they get. An OccupancyGrid over the same
+// cells picks free cells for fruit and respawns.
+//
+// A tick runs in three passes. The first decides every snake's move and claims
+// its target cell, the second resolves collisions, both reading only the board
+// as it was before the tick and writing only to the snake itself or to an atomic
+// claim counter, so they run in parallel on a JobSystem. The third applies the
+// moves in snake order on one thread, where fruit and respawns draw from the
+// arena's own Rng. Conflicts are settled by rule rather than by who gets there
+// first: all heads that meet on a cell die, and like Step() a tail that has not
+// moved yet still counts as body. The result depends only on the config and not
+// on the number of threads.
+class Arena
+{
+public:
+    explicit Arena(const ArenaConfig &config);
+
+    // back to tick 0 with every snake and fruit placed from config.seed
+    void Reset();
+
+    // one tick, spread over jobs when given
+    void Step(JobSystem *jobs = nullptr);
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    size_t SnakeCount() const { return snakes.size(); }
+
+    const ArenaSnake &Snake(size_t index) const { return snakes[index]; }
+
+    bool Fruit(const Vec2i &cell) const { return cells[CellIndex(cell)] == CELL_FRUIT; }
+
+    size_t Alive() const { return alive; }
+
+    uint64_t Tick() const { return tick; }
+
+    const ArenaStats &Stats() const { return stats; }
+
+    // hash of every snake and fruit, for checking two runs ended up the same
+    uint64_t Checksum() const;
+
+private:
+    static constexpr uint8_t CELL_EMPTY = 0;
+    static constexpr uint8_t CELL_BODY  = 1;
+    static constexpr uint8_t CELL_FRUIT = 2;
+
+    static constexpr size_t PASS_GRAIN = 256;  // snakes per job
+
+    size_t CellIndex(const Vec2i &cell) const { return static_cast<size_t>(cell.y) * width + cell.x; }
+
+    bool InBounds(const Vec2i &cell) const { return cell.x >= 0 && cell.x < width && cell.y >= 0 && cell.y < height; }
+
+    void Decide(ArenaSnake &snake);
+    void Apply();
+    void Kill(ArenaSnake &snake);
+    void Spawn(ArenaSnake &snake);
+    void SpawnFruit();
+
+    void PushHead(ArenaSnake &snake, const Vec2i &cell);
+    void PopTail(ArenaSnake &snake);
+
+    static void DecidePass(size_t begin, size_t end, void *context);
+    static void ResolvePass(size_t begin, size_t end, void *context);
+
+    ArenaConfig                             config;
+    int                                     width;
+    int                                     height;
+    std::vector<ArenaSnake>                 snakes;
+    std::vector<uint8_t>                    cells;      // CELL_ per cell
+    std::unique_ptr<std::atomic<uint8_t>[]> claims;     // heads moving onto each cell this tick, 0 between ticks
+    OccupancyGrid                           occupancy;  // body or fruit
+    Rng                                     rng;        // fruit and spawn cells
+    size_t                                  alive  = 0;
+    size_t                                  fruits = 0;
+    uint64_t                                tick   = 0;
+    ArenaStats                              stats;
+};
@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/autopilot.h"
+
+// ticks between path searches while chasing the tail
+static const uint32_t RETRY_TICKS = 8;
+
+// Cells kept free between the head and the tail on the cycle beyond the snake's
+// length; a shortcut skips cells that only become free again once the tail has
+// passed them, and this is the room left for eating meanwhile
+static const uint32_t CYCLE_BUFFER = 3;
+
+static Direction DirectionTo(const Vec2i &from, const Vec2i &to)
+{
+    if (to.x != from.x) {
+        return to.x > from.x ? Direction::Right : Direction::Left;
+    }
+    return to.y > from.y ? Direction::Up : Direction::Down;
+}
+
+static uint32_t Distance(const Vec2i &a, const Vec2i &b)
+{
+    return static_cast<uint32_t>(std::abs(a.x - b.x) + std::abs(a.y - b.y));
+}
+
+// Position of (u, v) along a comb over a u-by-v board with an even number of
+// rows: along row 0, then back and forth over columns 1.. of the other rows, and
+// down column 0 to the start
+static uint32_t CombIndex(uint32_t u, uint32_t v, uint32_t rowLength, uint32_t rows)
+{
+    if (v == 0) {
+        return u;
+    }
+    if (u == 0) {
+        return rowLength + (rows - 1) * (rowLength - 1) + (rows - 1 - v);
+    }
+    uint32_t base = rowLength + (v - 1) * (rowLength - 1);
+    return (v & 1) ? base + (rowLength - 1 - u) : base + (u - 1);
+}
+
+Autopilot::Autopilot(int gridWidth, int gridHeight, size_t searchBudget)
+    : width(gridWidth)
+    , height(gridHeight)
+    , cells(static_cast<uint32_t>(gridWidth) * gridHeight)
+    , searchBudget(searchBudget)
+{
+    if (height % 2 == 0) {
+        cycleAxis = CycleAxis::Rows;
+    } else if (width % 2 == 0) {
+        cycleAxis = CycleAxis::Columns;
+    }
+
+    // a search touches at most four new cells per expansion, keep the table at most half full
+    size_t reachable = std::min<size_t>(cells, 4 * searchBudget + 1);
+    nodeShift        = 32;
+    size_t capacity  = 1;
+    while (capacity < 2 * reachable) {
+        capacity <<= 1;
+        nodeShift--;
+    }
+    nodes.assign(capacity, Node{0, 0, 0, 0});
+    open.reserve(4 * searchBudget + 4);
+    queue.resize(reachable);
+    planSteps.resize(reachable);
+    virtualCells.resize((cells + 63) / 64);
+}
+
+void Autopilot::Reset()
+{
+    onCycle       = false;
+    planLength    = 0;
+    planNext      = 0;
+    checkedFruit  = Vec2i(-1, -1);
+    searchedFruit = Vec2i(-1, -1);
+    retryTicks    = 0;
+    joinSteps     = 0;
+}
+
+bool Autopilot::InBounds(const Vec2i &cell) const
+{
+    return cell.x >= 0 && cell.x < width && cell.y >= 0 && cell.y < height;
+}
+
+uint32_t Autopilot::CycleIndex(const Vec2i &cell) const
+{
+    uint32_t index = cycleAxis == CycleAxis::Rows ? CombIndex(cell.x, cell.y, width, height)
+                                                  : CombIndex(cell.y, cell.x, height, width);
+    return reversed ? cells - 1 - index : index;
+}
+
+uint32_t Autopilot::CycleOffset(const Vec2i &cell, uint32_t tailIndex) const
+{
+    uint32_t index = CycleIndex(cell);
+    return index >= tailIndex ? index - tailIndex : index + cells - tailIndex;
+}
+
+// the neighbour whose index is one higher, found by trying all four
+Vec2i Autopilot::CycleNext(const Vec2i &cell) const
+{
+    uint32_t next = CycleIndex(cell) + 1;
+    if (next == cells) {
+        next = 0;
+    }
+    for (int direction = 0; direction < 4; direction++) {
+        Vec2i neighbour = Neighbour(cell, static_cast<Direction>(direction));
+        if (InBounds(neighbour) && CycleIndex(neighbour) == next) {
+            return neighbour;
+        }
+    }
+    return cell;
+}
+
+bool Autopilot::CheckOnCycle(const SnakeBody &snake)
+{
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint32_t tailIndex = CycleIndex(snake.Tail());
+        uint32_t previous  = 0;
+        bool     ordered   = true;
+        for (size_t i = snake.Size() - 1; ordered && i-- > 0;) {
+            uint32_t offset = CycleOffset(snake[i], tailIndex);
+            ordered         = offset > previous;
+            previous        = offset;
+        }
+        if (ordered) {
+            return true;
+        }
+        reversed = !reversed;
+    }
+    return false;
+}
+
+Direction Autopilot::Decide(const GameState &state)
+{
+    stats.decisions++;
+
+    const SnakeBody &snake = state.snake;
+
+    // keep following the plan while the game is where it expected
+    if (planNext < planLength && snake.Head() == planHead && state.fruit == planFruit) {
+        return NextPlanStep();
+    }
+    planLength = 0;
+    planNext   = 0;
+
+    // once per fruit is enough, moves made on the cycle keep the body on it; a
+    // body that walked the cycle for as many steps as it is long is on it as well
+    if (!onCycle && HasCycle() && !(checkedFruit == state.fruit)) {
+        checkedFruit = state.fruit;
+        onCycle      = CheckOnCycle(snake);
+    }
+    if (!onCycle && HasCycle() && joinSteps + 1 >= snake.Size()) {
+        onCycle = true;
+    }
+
+    if (onCycle) {
+        if (!(searchedFruit == state.fruit)) {
+            searchedFruit = state.fruit;
+            if (PlanPath(state, true)) {
+                return NextPlanStep();
+            }
+        }
+        stats.cycleMoves++;
+        return FollowCycle(state);
+    }
+
+    // off the cycle, walk it to get onto it while that leaves the tail in reach
+    if (HasCycle()) {
+        Vec2i next    = CycleNext(snake.Head());
+        bool  reached = false;
+        if (!snake.Occupied(next)) {
+            Flood(next, snake.Tail(), false, snake, reached);
+        }
+        if (reached) {
+            joinSteps++;
+            stats.tailChases++;
+            return DirectionTo(snake.Head(), next);
+        }
+        joinSteps = 0;
+    }
+
+    if (!(searchedFruit == state.fruit) || retryTicks == 0) {
+        searchedFruit = state.fruit;
+        retryTicks    = RETRY_TICKS;
+        if (PlanPath(state, false) && PlanIsSafe(state)) {
+            return NextPlanStep();
+        }
+        planLength = 0;
+    }
+    retryTicks--;
+
+    stats.tailChases++;
+    return ChaseTail(state);
+}
+
+Direction Autopilot::NextPlanStep()
+{
+    int direction = planSteps[planNext++];
+    planHead      = Neighbour(planHead, static_cast<Direction>(direction));
+    joinSteps     = 0;
+    return static_cast<Direction>(direction);
+}
+
+// Moves forward along the cycle, skipping ahead towards the fruit as far as the
+// buffer behind the tail allows while the board is less than half full
+Direction Autopilot::FollowCycle(const GameState &state)
+{
+    const SnakeBody &snake     = state.snake;
+    Vec2i            head      = snake.Head();
+    uint32_t         length    = static_cast<uint32_t>(snake.Size());
+    uint32_t         tailIndex = CycleIndex(snake.Tail());
+    uint32_t         headAt    = CycleOffset(head, tailIndex);
+    uint32_t         toTail    = cells - headAt;
+    uint32_t         toFruit   = (CycleOffset(state.fruit, tailIndex) + cells - headAt) % cells;
+
+    int64_t  skip  = static_cast<int64_t>(toTail) - length - CYCLE_BUFFER;
+    uint32_t empty = cells - length - 1;
+    if (empty < cells / 2) {
+        skip = 0;
+    } else if (toFruit < toTail) {
+        // the fruit will make the snake longer before the tail moves on, keep more room
+        skip--;
+        if ((toTail - skip) * 4 > empty) {
+            skip -= 10;
+        }
+    }
+    skip = std::min<int64_t>(skip, toFruit);
+
+    // the farthest neighbour within reach, everything up to the tail is free
+    int      best     = -1;
+    uint32_t bestJump = 0;
+    for (int direction = 0; direction < 4; direction++) {
+        Vec2i neighbour = Neighbour(head, static_cast<Direction>(direction));
+        if (!InBounds(neighbour)) {
+            continue;
+        }
+        uint32_t jump = (CycleOffset(neighbour, tailIndex) + cells - headAt) % cells;
+        if (jump > bestJump && jump < toTail && (jump == 1 || jump <= skip)) {
+            best     = direction;
+            bestJump = jump;
+        }
+    }
+
+    if (best < 0) {
+        return DirectionTo(head, CycleNext(head));
+    }
+    return static_cast<Direction>(best);
+}
+
+// no safe path is known, so move towards the fruit among the cells from which the
+// tail can still be reached, or where there is the most room when there are none
+Direction Autopilot::ChaseTail(const GameState &state)
+{
+    const SnakeBody &snake = state.snake;
+
+    Direction best      = state.snakeDir;
+    size_t    bestScore = 0;
+    for (int direction = 0; direction < 4; direction++) {
+        Vec2i neighbour = Neighbour(snake.Head(), static_cast<Direction>(direction));
+        if (!InBounds(neighbour) || snake.Occupied(neighbour)) {
+            continue;
+        }
+
+        // with the tail in reach, head for the fruit; without, for the most room
+        bool   reached = false;
+        size_t area    = Flood(neighbour, snake.Tail(), false, snake, reached);
+        size_t score   = reached ? 2 * searchBudget + cells - Distance(neighbour, state.fruit) : area + 1;
+        if (score > bestScore) {
+            best      = static_cast<Direction>(direction);
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+bool Autopilot::PlanPath(const GameState &state, bool alongCycle)
+{
+    stats.searches++;
+    NewSearch();
+    open.clear();
+
+    const SnakeBody &snake     = state.snake;
+    Vec2i            start     = snake.Head();
+    uint32_t         goal      = CellIndex(state.fruit);
+    uint32_t         tailIndex = alongCycle ? CycleIndex(snake.Tail()) : 0;
+    uint32_t         goalAt    = alongCycle ? CycleOffset(state.fruit, tailIndex) : 0;
+
+    auto lower = [](const OpenEntry &a, const OpenEntry &b) { return a.f > b.f || (a.f == b.f && a.g < b.g); };
+
+    bool  fresh;
+    Node *first = Insert(CellIndex(start), fresh);
+    first->g    = 0;
+    open.push_back(OpenEntry{Distance(start, state.fruit), 0, CellIndex(start)});
+
+    size_t expanded = 0;
+    bool   found    = false;
+    while (!open.empty() && expanded < searchBudget) {
+        std::pop_heap(open.begin(), open.end(), lower);
+        OpenEntry entry = open.back();
+        open.pop_back();
+
+        // a shorter way to this cell was queued after this entry
+        if (entry.g > Find(entry.cell)->g) {
+            continue;
+        }
+        if (entry.cell == goal) {
+            found = true;
+            break;
+        }
+        expanded++;
+
+        Vec2i    cell = CellAt(entry.cell);
+        uint32_t at   = alongCycle ? CycleOffset(cell, tailIndex) : 0;
+        for (int direction = 0; direction < 4; direction++) {
+            Vec2i neighbour = Neighbour(cell, static_cast<Direction>(direction));
+            if (!InBounds(neighbour)) {
+                continue;
+            }
+
+            // on the cycle only forward through the free stretch, which needs no occupancy test
+            if (alongCycle) {
+                uint32_t neighbourAt = CycleOffset(neighbour, tailIndex);
+                if (neighbourAt <= at || neighbourAt > goalAt) {
+                    continue;
+                }
+            } else if (snake.Occupied(neighbour)) {
+                continue;
+            }
+
+            uint32_t g    = entry.g + 1;
+            Node    *node = Insert(CellIndex(neighbour), fresh);
+            if (!fresh && node->g <= g) {
+                continue;
+            }
+            node->g      = g;
+            node->parent = direction;
+            open.push_back(OpenEntry{g + Distance(neighbour, state.fruit), g, CellIndex(neighbour)});
+            std::push_heap(open.begin(), open.end(), lower);
+        }
+    }
+    stats.expansions += expanded;
+
+    if (!found) {
+        return false;
+    }
+
+    // on the cycle the path skips cells ahead of the head while the tail moves
+    // at least a cell per step until the fruit is eaten; the same buffer as in
+    // FollowCycle has to be left afterwards
+    if (alongCycle) {
+        uint32_t length     = static_cast<uint32_t>(snake.Size());
+        uint32_t pathLength = Find(goal)->g;
+        uint32_t empty      = cells - length - 1;
+        if (empty < cells / 2 || goalAt + length + CYCLE_BUFFER + 2 > cells + pathLength) {
+            return false;
+        }
+    }
+
+    // walk back from the fruit, writing the steps back to front
+    planLength = Find(goal)->g;
+    Vec2i cell = state.fruit;
+    for (size_t i = planLength; i-- > 0;) {
+        int direction = Find(CellIndex(cell))->parent;
+        planSteps[i]  = static_cast<uint8_t>(direction);
+        cell          = Neighbour(cell, Reverse(static_cast<Direction>(direction)));
+    }
+    planNext  = 0;
+    planHead  = start;
+    planFruit = state.fruit;
+    return planLength > 0;
+}
+
+bool Autopilot::PlanIsSafe(const GameState &state)
+{
+    const SnakeBody &snake  = state.snake;
+    size_t           length = snake.Size();
+
+    // after the plan the body is the last length + 1 cells of the path followed by
+    // what is left of the old body; mark them in the virtual bitboard
+    std::fill(virtualCells.begin(), virtualCells.end(), 0);
+    auto mark = [this](const Vec2i &cell) {
+        uint32_t bit = CellIndex(cell);
+        virtualCells[bit >> 6] |= 1ULL << (bit & 63);
+    };
+
+    Vec2i cell = snake.Head();
+    Vec2i tail = planLength > length ? cell : snake[length - planLength];
+    for (size_t i = 0; i < planLength; i++) {
+        cell = Neighbour(cell, static_cast<Direction>(planSteps[i]));
+        if (i + length + 1 >= planLength) {
+            mark(cell);
+            if (i + length + 1 == planLength) {
+                tail = cell;
+            }
+        }
+    }
+    for (size_t i = 0; i + planLength <= length; i++) {
+        mark(snake[i]);
+    }
+
+    bool reached = false;
+    Flood(cell, tail, true, snake, reached);
+    return reached;
+}
+
+size_t Autopilot::Flood(const Vec2i &start, const Vec2i &target, bool useVirtual, const SnakeBody &snake, bool &reached)
+{
+    NewSearch();
+
+    auto blocked = [&](const Vec2i &cell) {
+        if (!useVirtual) {
+            return snake.Occupied(cell);
+        }
+        uint32_t bit = CellIndex(cell);
+        return ((virtualCells[bit >> 6] >> (bit & 63)) & 1) != 0;
+    };
+
+    bool   fresh;
+    size_t head  = 0;
+    size_t count = 0;
+    Insert(CellIndex(start), fresh);
+    queue[count++] = CellIndex(start);
+
+    // an open area bigger than the budget is as good as reaching the tail
+    reached = false;
+    while (head < count) {
+        Vec2i cell = CellAt(queue[head++]);
+        for (int direction = 0; direction < 4; direction++) {
+            Vec2i neighbour = Neighbour(cell, static_cast<Direction>(direction));
+            if (!InBounds(neighbour)) {
+                continue;
+            }
+            if (neighbour == target) {
+                reached = true;
+            }
+            if (blocked(neighbour)) {
+                continue;
+            }
+            Insert(CellIndex(neighbour), fresh);
+            if (!fresh) {
+                continue;
+            }
+            if (count == queue.size() || count >= searchBudget) {
+                reached = true;
+                return count;
+            }
+            queue[count++] = CellIndex(neighbour);
+        }
+    }
+    return count;
+}
+
+void Autopilot::NewSearch()
+{
+    // stamp 0 marks empty slots, clear them all when the stamp wraps
+    if (++stamp == 0) {
+        std::fill(nodes.begin(), nodes.end(), Node{0, 0, 0, 0});
+        stamp = 1;
+    }
+}
+
+Autopilot::Node *Autopilot::Find(uint32_t cell)
+{
+    size_t mask = nodes.size() - 1;
+    for (size_t slot = (cell * 0x9e3779b1u) >> nodeShift;; slot = (slot + 1) & mask) {
+        Node &node = nodes[slot];
+        if (node.stamp != stamp) {
+            return nullptr;
+        }
+        if (node.cell == cell) {
+            return &node;
+        }
+    }
+}
+
+Autopilot::Node *Autopilot::Insert(uint32_t cell, bool &fresh)
+{
+    size_t mask = nodes.size() - 1;
+    for (size_t slot = (cell * 0x9e3779b1u) >> nodeShift;; slot = (slot + 1) & mask) {
+        Node &node = nodes[slot];
+        if (node.stamp != stamp) {
+            node  = Node{cell, stamp, UINT32_MAX, 0};
+            fresh = true;
+            return &node;
+        }
+        if (node.cell == cell) {
+            fresh = false;
+            return &node;
+        }
+    }
+}
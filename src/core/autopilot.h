@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/gameState.h"
+#include "core/vec.h"
+
+struct AutopilotStats
+{
+    uint64_t decisions  = 0;
+    uint64_t searches   = 0;  // A* runs, about one per fruit
+    uint64_t expansions = 0;  // nodes expanded by all searches
+    uint64_t cycleMoves = 0;  // moves along the Hamiltonian cycle when no path was found in budget
+    uint64_t tailChases = 0;  // moves made while no safe path to the fruit was known
+};
+
+// Plays the game by choosing the input for each tick, for Step(). While the body
+// lies in order along a Hamiltonian cycle of the board, the free cells all sit on
+// the stretch of the cycle ahead of the head, so any move that stays on that
+// stretch keeps the snake safe until the board is full. Each fruit gets one A*
+// search for the shortest route through that stretch, which is then followed
+// tick by tick; when the search runs out of budget the snake takes the cycle
+// step, cutting corners towards the fruit where it can. A body that is not on
+// the cycle walks it until it is, and boards without one (both sides odd) fall
+// back to A* over the occupancy bitboard, taking a path only if the tail can
+// still be reached after eating, and otherwise staying where the tail is in reach.
+//
+// Searches are bounded by searchBudget expansions and use preallocated tables
+// stamped per search, so Decide() does not allocate and its cost does not grow
+// with the board.
+class Autopilot
+{
+public:
+    static constexpr size_t DEFAULT_SEARCH_BUDGET = 1 << 16;
+
+    Autopilot(int gridWidth, int gridHeight, size_t searchBudget = DEFAULT_SEARCH_BUDGET);
+
+    // call after ResetGame, drops the plan
+    void Reset();
+
+    Direction Decide(const GameState &state);
+
+    // the board has a Hamiltonian cycle, which needs an even side
+    bool HasCycle() const { return cycleAxis != CycleAxis::None; }
+
+    const AutopilotStats &Stats() const { return stats; }
+
+private:
+    enum class CycleAxis
+    {
+        None,
+        Rows,    // a comb along the rows, height is even
+        Columns  // the same along the columns, width is even
+    };
+
+    struct Node
+    {
+        uint32_t cell;
+        uint32_t stamp;
+        uint32_t g;
+        uint32_t parent;  // direction taken into the cell
+    };
+
+    struct OpenEntry
+    {
+        uint32_t f;
+        uint32_t g;
+        uint32_t cell;
+    };
+
+    uint32_t CellIndex(const Vec2i &cell) const { return static_cast<uint32_t>(cell.y) * width + cell.x; }
+    Vec2i    CellAt(uint32_t index) const { return Vec2i(index % width, index / width); }
+    bool     InBounds(const Vec2i &cell) const;
+
+    // position along the cycle, and the offset of cell counted forward from the tail
+    uint32_t CycleIndex(const Vec2i &cell) const;
+    uint32_t CycleOffset(const Vec2i &cell, uint32_t tailIndex) const;
+    Vec2i    CycleNext(const Vec2i &cell) const;
+
+    // checks the body runs forward along the cycle from tail to head, trying both orientations
+    bool CheckOnCycle(const SnakeBody &snake);
+
+    // fills the plan with the shortest path from the head to the fruit, only through
+    // the free stretch of the cycle when alongCycle
+    bool PlanPath(const GameState &state, bool alongCycle);
+
+    // whether the tail is still reachable once the plan has been followed and the fruit eaten
+    bool PlanIsSafe(const GameState &state);
+
+    Direction NextPlanStep();
+    Direction FollowCycle(const GameState &state);
+    Direction ChaseTail(const GameState &state);
+
+    // cells reachable from start, up to the search budget; reached is set when target
+    // is among them or the budget runs out
+    size_t Flood(const Vec2i &start, const Vec2i &target, bool useVirtual, const SnakeBody &snake, bool &reached);
+
+    void  NewSearch();
+    Node *Find(uint32_t cell);
+    Node *Insert(uint32_t cell, bool &fresh);
+
+    int       width;
+    int       height;
+    uint32_t  cells;
+    size_t    searchBudget;
+    CycleAxis cycleAxis = CycleAxis::None;
+    bool      reversed  = false;
+    bool      onCycle   = false;
+
+    // the plan, followed while the head and fruit are where it expects
+    std::vector<uint8_t> planSteps;
+    size_t               planLength = 0;
+    size_t               planNext   = 0;
+    Vec2i                planHead;
+    Vec2i                planFruit;
+
+    // what was already tried for the current fruit
+    Vec2i    checkedFruit  = Vec2i(-1, -1);
+    Vec2i    searchedFruit = Vec2i(-1, -1);
+    uint32_t retryTicks    = 0;
+    size_t   joinSteps     = 0;  // cycle steps in a row taken while off it
+
+    // search tables, reused through stamps
+    std::vector<Node>      nodes;
+    uint32_t               nodeShift = 0;
+    uint32_t               stamp     = 0;
+    std::vector<OpenEntry> open;
+    std::vector<uint32_t>  queue;
+    std::vector<uint64_t>  virtualCells;  // occupancy after following the plan
+
+    AutopilotStats stats;
+};
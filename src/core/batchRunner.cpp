@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/autopilot.h"
+#include "core/batchRunner.h"
+#include "core/batchSim.h"
+#include "core/jobSystem.h"
+#include "core/rng.h"
+
+void BatchRunStats::Add(const GameState &state)
+{
+    bestScore  = games == 0 ? state.score : std::max(bestScore, state.score);
+    worstScore = games == 0 ? state.score : std::min(worstScore, state.score);
+    games++;
+    wins += state.gameWon;
+    deaths += state.gameOver && !state.gameWon;
+    ticks += state.tick;
+    lengthSum += state.snake.Size();
+    scoreSum += state.score;
+    scoreSquares += static_cast<int64_t>(state.score) * state.score;
+}
+
+void BatchRunStats::Add(const BatchRunStats &other)
+{
+    if (other.games == 0) {
+        return;
+    }
+    bestScore  = games == 0 ? other.bestScore : std::max(bestScore, other.bestScore);
+    worstScore = games == 0 ? other.worstScore : std::min(worstScore, other.worstScore);
+    games += other.games;
+    wins += other.wins;
+    deaths += other.deaths;
+    ticks += other.ticks;
+    lengthSum += other.lengthSum;
+    scoreSum += other.scoreSum;
+    scoreSquares += other.scoreSquares;
+}
+
+double BatchRunStats::MeanScore() const
+{
+    return games > 0 ? static_cast<double>(scoreSum) / games : 0.0;
+}
+
+double BatchRunStats::ScoreDeviation() const
+{
+    if (games == 0) {
+        return 0.0;
+    }
+    double mean = MeanScore();
+    return std::sqrt(std::max(0.0, static_cast<double>(scoreSquares) / games - mean * mean));
+}
+
+double BatchRunStats::MeanLength() const
+{
+    return games > 0 ? static_cast<double>(lengthSum) / games : 0.0;
+}
+
+// what one worker reuses from game to game, on cache lines of its own
+struct alignas(64) BatchWorker
+{
+    GameState                  state;
+    std::unique_ptr<Autopilot> autopilot;
+    Rng                        rng;
+    BatchRunStats              stats;
+};
+
+struct BatchRun
+{
+    const BatchRunConfig    *config;
+    uint64_t                 maxTicks;
+    std::vector<BatchWorker> workers;
+};
+
+static void PlayGames(size_t begin, size_t end, void *context)
+{
+    BatchRun             &run    = *static_cast<BatchRun *>(context);
+    const BatchRunConfig &config = *run.config;
+    BatchWorker          &worker = run.workers[JobSystem::WorkerIndex()];
+    GameState            &state  = worker.state;
+
+    auto blocked = [&state](Direction direction) { return Blocked(state, direction); };
+    for (size_t game = begin; game < end; game++) {
+        uint64_t seed = BatchSim::EpisodeSeed(config.seed, game, 0);
+        ResetGame(state, seed);
+        state.snakeDir = Direction::Right;
+        if (worker.autopilot) {
+            worker.autopilot->Reset();
+        }
+        worker.rng.Seed(seed, 2);
+
+        while (!state.gameOver && state.tick < run.maxTicks) {
+            Direction input = worker.autopilot ? worker.autopilot->Decide(state)
+                                               : RandomPolicyInput(state.snakeDir, worker.rng, blocked);
+            Step(state, input);
+        }
+        worker.stats.Add(state);
+    }
+}
+
+BatchRunStats RunBatchGames(JobSystem &jobs, const BatchRunConfig &config)
+{
+    BatchRun run;
+    run.config   = &config;
+    run.maxTicks = config.maxTicks;
+    if (run.maxTicks == 0) {
+        uint64_t cells = static_cast<uint64_t>(config.width) * config.height;
+        run.maxTicks   = cells * cells;
+    }
+
+    run.workers.resize(jobs.WorkerCount());
+    for (BatchWorker &worker : run.workers) {
+        worker.state = GameState(config.width, config.height);
+        if (config.policy == BatchPolicy::Autopilot) {
+            worker.autopilot = std::make_unique<Autopilot>(config.width, config.height);
+        }
+    }
+
+    jobs.ParallelFor(config.games, 1, PlayGames, &run);
+
+    BatchRunStats total;
+    for (const BatchWorker &worker : run.workers) {
+        total.Add(worker.stats);
+    }
+    return total;
+}
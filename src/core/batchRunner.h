@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/gameState.h"
+
+class JobSystem;
+
+// percent of ticks on which the random policy turns
+const uint32_t RANDOM_TURN_CHANCE = 10;
+
+enum class BatchPolicy
+{
+    Autopilot,
+    Random  // turns at random now and then, and away from what is straight ahead
+};
+
+struct BatchRunConfig
+{
+    int         width    = GRID_WIDTH;
+    int         height   = GRID_HEIGHT;
+    size_t      games    = 1000;
+    uint64_t    seed     = 1;
+    uint64_t    maxTicks = 0;  // per game, 0 is the number of cells squared
+    BatchPolicy policy   = BatchPolicy::Autopilot;
+};
+
+// Totals over finished games. Integer sums only, so adding them up in any order
+// gives the same result however the games were spread over threads.
+struct BatchRunStats
+{
+    uint64_t games        = 0;
+    uint64_t wins         = 0;
+    uint64_t deaths       = 0;  // games that hit maxTicks count as neither
+    uint64_t ticks        = 0;
+    uint64_t lengthSum    = 0;
+    int64_t  scoreSum     = 0;
+    int64_t  scoreSquares = 0;
+    int      bestScore    = 0;
+    int      worstScore   = 0;
+
+    void Add(const GameState &state);
+    void Add(const BatchRunStats &other);
+
+    double MeanScore() const;
+    double ScoreDeviation() const;
+    double MeanLength() const;
+};
+
+// Plays config.games headless games on the job system's workers. Game i is
+// seeded with BatchSim::EpisodeSeed(config.seed, i, 0) and starts heading right
+// as when the player starts it, so the result depends only on the config. Each
+// worker keeps its own GameState, policy state and totals, and games are
+// handed out in halves by ParallelFor so that workers left idle by short games
+// steal the rest.
+BatchRunStats RunBatchGames(JobSystem &jobs, const BatchRunConfig &config);
+
+// The random policy: a random turn now and then, or whenever blocked(heading)
+// says going on would end the game; the first of the four directions from a
+// random start that is not blocked. None keeps the heading.
+template<typename BlockedFn>
+Direction RandomPolicyInput(Direction heading, Rng &rng, BlockedFn blocked)
+{
+    if (rng.NextBelow(100) >= RANDOM_TURN_CHANCE && !blocked(heading)) {
+        return Direction::None;
+    }
+
+    uint32_t first = rng.NextBelow(4);
+    for (uint32_t i = 0; i < 4; i++) {
+        Direction direction = static_cast<Direction>((first + i) % 4);
+        if (!blocked(direction)) {
+            return direction;
+        }
+    }
+    return Direction::None;
+}
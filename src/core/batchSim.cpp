@@ -0,0 +1,360 @@
+#include <iterator>
+
+#include "core/batchSim.h"
+#include "core/bits.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define CHAD_HAVE_SSE2 1
+#    include <emmintrin.h>
+#else
+#    define CHAD_HAVE_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#endif
+
+// defined in batchSimAvx2.cpp, false when that file was built without AVX2 codegen
+bool Avx2KernelCompiled();
+
+// starting snake as in ResetGame, on the middle row
+static const int START_COLUMNS[] = {5, 4, 3};
+
+static bool CpuHasAvx2()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+void MoveKernelScalar(const MoveLanes &lanes, size_t begin, size_t end)
+{
+    const int32_t NONE = static_cast<int32_t>(Direction::None);
+
+    for (size_t i = begin; i < end; i++) {
+        // same rule as ApplyInput: Up/Down and Left/Right differ only in bit 0
+        int32_t d  = lanes.dir[i];
+        int32_t in = lanes.input[i];
+        if (in != NONE && in != (d ^ 1)) {
+            d = in;
+        }
+        lanes.dir[i] = d;
+
+        int32_t dx = (d == static_cast<int32_t>(Direction::Right)) - (d == static_cast<int32_t>(Direction::Left));
+        int32_t dy = (d == static_cast<int32_t>(Direction::Up)) - (d == static_cast<int32_t>(Direction::Down));
+        int32_t x  = lanes.headX[i] + dx;
+        int32_t y  = lanes.headY[i] + dy;
+
+        int32_t flags = 0;
+        if (d != NONE) {
+            flags |= MOVE_MOVED;
+        }
+        if (x < 0 || x >= lanes.width || y < 0 || y >= lanes.height) {
+            flags |= MOVE_WALL;
+        }
+        if (x == lanes.fruitX[i] && y == lanes.fruitY[i]) {
+            flags |= MOVE_FRUIT;
+        }
+
+        lanes.nextX[i] = x;
+        lanes.nextY[i] = y;
+        lanes.flags[i] = flags;
+    }
+}
+
+size_t MoveKernelSse2(const MoveLanes &lanes, size_t count)
+{
+#if CHAD_HAVE_SSE2
+    const __m128i one    = _mm_set1_epi32(1);
+    const __m128i none   = _mm_set1_epi32(static_cast<int32_t>(Direction::None));
+    const __m128i up     = _mm_set1_epi32(static_cast<int32_t>(Direction::Up));
+    const __m128i down   = _mm_set1_epi32(static_cast<int32_t>(Direction::Down));
+    const __m128i left   = _mm_set1_epi32(static_cast<int32_t>(Direction::Left));
+    const __m128i right  = _mm_set1_epi32(static_cast<int32_t>(Direction::Right));
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i maxX   = _mm_set1_epi32(lanes.width - 1);
+    const __m128i maxY   = _mm_set1_epi32(lanes.height - 1);
+    const __m128i fMoved = _mm_set1_epi32(MOVE_MOVED);
+    const __m128i fWall  = _mm_set1_epi32(MOVE_WALL);
+    const __m128i fFruit = _mm_set1_epi32(MOVE_FRUIT);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d  = _mm_loadu_si128((const __m128i *)(lanes.dir + i));
+        __m128i in = _mm_loadu_si128((const __m128i *)(lanes.input + i));
+
+        // take the input unless it is None or the reverse of the heading
+        __m128i reject = _mm_or_si128(_mm_cmpeq_epi32(in, none), _mm_cmpeq_epi32(in, _mm_xor_si128(d, one)));
+        d              = _mm_or_si128(_mm_and_si128(reject, d), _mm_andnot_si128(reject, in));
+        _mm_storeu_si128((__m128i *)(lanes.dir + i), d);
+
+        // compare masks are -1, so mask(a) - mask(b) is the step along that axis
+        __m128i dx = _mm_sub_epi32(_mm_cmpeq_epi32(d, left), _mm_cmpeq_epi32(d, right));
+        __m128i dy = _mm_sub_epi32(_mm_cmpeq_epi32(d, down), _mm_cmpeq_epi32(d, up));
+        __m128i x  = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(lanes.headX + i)), dx);
+        __m128i y  = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(lanes.headY + i)), dy);
+
+        __m128i moved = _mm_andnot_si128(_mm_cmpeq_epi32(d, none), fMoved);
+        __m128i wall  = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi32(x, zero), _mm_cmpgt_epi32(x, maxX)),
+                                    _mm_or_si128(_mm_cmplt_epi32(y, zero), _mm_cmpgt_epi32(y, maxY)));
+        __m128i fruit = _mm_and_si128(_mm_cmpeq_epi32(x, _mm_loadu_si128((const __m128i *)(lanes.fruitX + i))),
+                                      _mm_cmpeq_epi32(y, _mm_loadu_si128((const __m128i *)(lanes.fruitY + i))));
+
+        __m128i flags = _mm_or_si128(moved, _mm_or_si128(_mm_and_si128(wall, fWall), _mm_and_si128(fruit, fFruit)));
+
+        _mm_storeu_si128((__m128i *)(lanes.nextX + i), x);
+        _mm_storeu_si128((__m128i *)(lanes.nextY + i), y);
+        _mm_storeu_si128((__m128i *)(lanes.flags + i), flags);
+    }
+    return i;
+#else
+    return 0;
+#endif
+}
+
+const char *BatchSim::KernelName(BatchKernel kernel)
+{
+    switch (kernel) {
+        case BatchKernel::Auto:
+            return "auto";
+        case BatchKernel::Scalar:
+            return "scalar";
+        case BatchKernel::Sse2:
+            return "sse2";
+        case BatchKernel::Avx2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+bool BatchSim::KernelSupported(BatchKernel kernel)
+{
+    switch (kernel) {
+        case BatchKernel::Auto:
+        case BatchKernel::Scalar:
+            return true;
+        case BatchKernel::Sse2:
+            return CHAD_HAVE_SSE2 != 0;
+        case BatchKernel::Avx2:
+            return Avx2KernelCompiled() && CpuHasAvx2();
+    }
+    return false;
+}
+
+uint64_t BatchSim::EpisodeSeed(uint64_t seed, size_t game, uint64_t episode)
+{
+    // splitmix64 finalizer over the three inputs
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (game + 1) + 0xbf58476d1ce4e5b9ULL * episode;
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+BatchSim::BatchSim(size_t gameCount, uint64_t seed, int gridWidth, int gridHeight, BatchKernel kernel)
+    : count(gameCount)
+    , seed(seed)
+    , width(gridWidth)
+    , height(gridHeight)
+    , cells(static_cast<uint32_t>(gridWidth * gridHeight))
+    , words((cells + 63) / 64)
+    , kernel(kernel)
+    , dir(gameCount)
+    , input(gameCount)
+    , headX(gameCount)
+    , headY(gameCount)
+    , fruitX(gameCount)
+    , fruitY(gameCount)
+    , nextX(gameCount)
+    , nextY(gameCount)
+    , flags(gameCount)
+    , score(gameCount)
+    , finalScore(gameCount)
+    , speed(gameCount)
+    , ringHead(gameCount)
+    , length(gameCount)
+    , freeCount(gameCount)
+    , episode(gameCount, 0)
+    , done(gameCount, 0)
+    , rng(gameCount)
+    , occupancy(gameCount * words)
+    , ring(gameCount * cells)
+{
+    // pick the widest kernel this build and CPU can run
+    if (this->kernel == BatchKernel::Auto || !KernelSupported(this->kernel)) {
+        this->kernel = KernelSupported(BatchKernel::Avx2)   ? BatchKernel::Avx2
+                       : KernelSupported(BatchKernel::Sse2) ? BatchKernel::Sse2
+                                                            : BatchKernel::Scalar;
+    }
+
+    for (size_t game = 0; game < count; game++) {
+        ResetLane(game);
+    }
+}
+
+Vec2i BatchSim::Segment(size_t game, size_t i) const
+{
+    uint32_t index = ringHead[game] + static_cast<uint32_t>(i);
+    if (index >= cells) {
+        index -= cells;
+    }
+    uint32_t cell = ring[game * cells + index];
+    return Vec2i(static_cast<int>(cell % width), static_cast<int>(cell / width));
+}
+
+void BatchSim::Step(const Direction *inputs)
+{
+    for (size_t game = 0; game < count; game++) {
+        input[game] = static_cast<int32_t>(inputs[game]);
+    }
+
+    MoveLanes lanes = {dir.data(),
+                       input.data(),
+                       headX.data(),
+                       headY.data(),
+                       fruitX.data(),
+                       fruitY.data(),
+                       nextX.data(),
+                       nextY.data(),
+                       flags.data(),
+                       width,
+                       height};
+
+    size_t vectorized = 0;
+    if (kernel == BatchKernel::Avx2) {
+        vectorized = MoveKernelAvx2(lanes, count);
+    } else if (kernel == BatchKernel::Sse2) {
+        vectorized = MoveKernelSse2(lanes, count);
+    }
+    MoveKernelScalar(lanes, vectorized, count);
+
+    for (size_t game = 0; game < count; game++) {
+        AdvanceLane(game);
+    }
+}
+
+void BatchSim::ResetLane(size_t game)
+{
+    // bits past the last cell count as occupied, so fruit is never placed there
+    for (uint32_t w = 0; w < words; w++) {
+        occupancy[game * words + w] = 0;
+    }
+    if (cells % 64) {
+        occupancy[game * words + words - 1] = ~uint64_t(0) << (cells % 64);
+    }
+    freeCount[game] = cells;
+    ringHead[game]  = 0;
+    length[game]    = 0;
+
+    int32_t row = height / 2;
+    for (size_t i = std::size(START_COLUMNS); i-- > 0;) {
+        PushHead(game, static_cast<uint32_t>(row * width + START_COLUMNS[i]));
+    }
+
+    headX[game] = START_COLUMNS[0];
+    headY[game] = row;
+    dir[game]   = static_cast<int32_t>(Direction::None);
+    score[game] = 0;
+    speed[game] = UPDATE_INTERVAL;
+    rng[game].Seed(EpisodeSeed(seed, game, episode[game]));
+
+    SpawnFruit(game);
+}
+
+void BatchSim::AdvanceLane(size_t game)
+{
+    done[game] = 0;
+
+    int32_t laneFlags = flags[game];
+    if (!(laneFlags & MOVE_MOVED)) {
+        return;
+    }
+
+    bool     ended = (laneFlags & MOVE_WALL) != 0;
+    uint32_t cell  = static_cast<uint32_t>(nextY[game] * width + nextX[game]);
+
+    // self collision, the tail has not moved yet so it still counts
+    if (!ended && ((occupancy[game * words + (cell >> 6)] >> (cell & 63)) & 1)) {
+        ended = true;
+    }
+
+    if (!ended) {
+        PushHead(game, cell);
+        headX[game] = nextX[game];
+        headY[game] = nextY[game];
+
+        if (laneFlags & MOVE_FRUIT) {
+            score[game] += 10;
+            SpawnFruit(game);
+
+            // speed increase every 5 fruits
+            if (score[game] % 50 == 0 && speed[game] > 0.05f) {
+                speed[game] -= 0.01f;
+            }
+
+            // a full board is a win, which ends the episode too
+            ended = freeCount[game] == 0;
+        } else {
+            PopTail(game);
+        }
+    }
+
+    if (ended) {
+        done[game]       = 1;
+        finalScore[game] = score[game];
+        episode[game]++;
+        ResetLane(game);
+    }
+}
+
+void BatchSim::SpawnFruit(size_t game)
+{
+    if (freeCount[game] == 0) {
+        return;
+    }
+
+    // the n-th free cell in row-major order, like OccupancyGrid::NthFree
+    uint32_t        n     = rng[game].NextBelow(freeCount[game]);
+    const uint64_t *board = &occupancy[game * words];
+    for (uint32_t w = 0;; w++) {
+        uint64_t free   = ~board[w];
+        uint32_t inWord = static_cast<uint32_t>(Popcount64(free));
+        if (n < inWord) {
+            uint32_t cell = w * 64 + static_cast<uint32_t>(SelectBit64(free, static_cast<int>(n)));
+            fruitX[game]  = static_cast<int32_t>(cell % width);
+            fruitY[game]  = static_cast<int32_t>(cell / width);
+            return;
+        }
+        n -= inWord;
+    }
+}
+
+void BatchSim::PushHead(size_t game, uint32_t cell)
+{
+    uint32_t headIndex = ringHead[game] == 0 ? cells - 1 : ringHead[game] - 1;
+
+    ring[game * cells + headIndex] = static_cast<uint16_t>(cell);
+    ringHead[game]                 = headIndex;
+    length[game]++;
+
+    occupancy[game * words + (cell >> 6)] |= uint64_t(1) << (cell & 63);
+    freeCount[game]--;
+}
+
+void BatchSim::PopTail(size_t game)
+{
+    uint32_t tailIndex = ringHead[game] + length[game] - 1;
+    if (tailIndex >= cells) {
+        tailIndex -= cells;
+    }
+    uint32_t cell = ring[game * cells + tailIndex];
+
+    occupancy[game * words + (cell >> 6)] &= ~(uint64_t(1) << (cell & 63));
+    freeCount[game]++;
+    length[game]--;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/gameState.h"
+#include "core/rng.h"
+#include "core/vec.h"
+
+enum class BatchKernel
+{
+    Auto,
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Lane arrays handed to the movement kernels, one entry per game
+struct MoveLanes
+{
+    int32_t       *dir;
+    const int32_t *input;
+    const int32_t *headX;
+    const int32_t *headY;
+    const int32_t *fruitX;
+    const int32_t *fruitY;
+    int32_t       *nextX;
+    int32_t       *nextY;
+    int32_t       *flags;
+    int32_t        width;
+    int32_t        height;
+};
+
+// kernel output flags
+const int32_t MOVE_MOVED = 1;
+const int32_t MOVE_WALL  = 2;
+const int32_t MOVE_FRUIT = 4;
+
+// Steps many independent games in lockstep, following the same rules as Step() in
+// gameState.h. Per-game scalars are kept in structure-of-arrays form so turning,
+// movement, wall and fruit checks run as SSE2/AVX2 kernels across games; the
+// occupancy test, body update and fruit placement then touch only the game's own
+// bitboard and ring. Games that end are restarted in place with their next
+// episode seed, so game i, episode k matches ResetGame(state, EpisodeSeed(seed, i, k))
+// stepped with the same inputs.
+class BatchSim
+{
+public:
+    // grids are limited to 65536 cells, cell indices are stored as uint16_t
+    BatchSim(size_t gameCount,
+             uint64_t seed,
+             int gridWidth = GRID_WIDTH,
+             int gridHeight = GRID_HEIGHT,
+             BatchKernel kernel = BatchKernel::Auto);
+
+    // one tick for every game, inputs holds one direction per game
+    void Step(const Direction *inputs);
+
+    size_t Size() const { return count; }
+
+    Vec2i Head(size_t game) const { return Vec2i(headX[game], headY[game]); }
+
+    Vec2i Fruit(size_t game) const { return Vec2i(fruitX[game], fruitY[game]); }
+
+    int Score(size_t game) const { return score[game]; }
+
+    size_t Length(size_t game) const { return length[game]; }
+
+    // set when the game ended during the last Step and was restarted
+    bool Done(size_t game) const { return done[game] != 0; }
+
+    int FinalScore(size_t game) const { return finalScore[game]; }
+
+    float Speed(size_t game) const { return speed[game]; }
+
+    uint64_t Episode(size_t game) const { return episode[game]; }
+
+    // segment i of game counted from the head
+    Vec2i Segment(size_t game, size_t i) const;
+
+    BatchKernel Kernel() const { return kernel; }
+
+    static const char *KernelName(BatchKernel kernel);
+
+    static bool KernelSupported(BatchKernel kernel);
+
+    static uint64_t EpisodeSeed(uint64_t seed, size_t game, uint64_t episode);
+
+private:
+    template<typename T>
+    using Lanes = std::vector<T>;
+
+    void ResetLane(size_t game);
+    void AdvanceLane(size_t game);
+    void SpawnFruit(size_t game);
+
+    void PushHead(size_t game, uint32_t cell);
+    void PopTail(size_t game);
+
+    size_t      count;
+    uint64_t    seed;
+    int32_t     width;
+    int32_t     height;
+    uint32_t    cells;
+    uint32_t    words;
+    BatchKernel kernel;
+
+    // per-game scalars
+    Lanes<int32_t>  dir;
+    Lanes<int32_t>  input;
+    Lanes<int32_t>  headX;
+    Lanes<int32_t>  headY;
+    Lanes<int32_t>  fruitX;
+    Lanes<int32_t>  fruitY;
+    Lanes<int32_t>  nextX;
+    Lanes<int32_t>  nextY;
+    Lanes<int32_t>  flags;
+    Lanes<int32_t>  score;
+    Lanes<int32_t>  finalScore;
+    Lanes<float>    speed;
+    Lanes<uint32_t> ringHead;
+    Lanes<uint32_t> length;
+    Lanes<uint32_t> freeCount;
+    Lanes<uint64_t> episode;
+    Lanes<uint8_t>  done;
+    Lanes<Rng>      rng;
+
+    // per-game blocks: words bitboard entries, cells ring entries
+    Lanes<uint64_t> occupancy;
+    Lanes<uint16_t> ring;
+};
+
+// movement kernels, lanes [begin, end)
+void MoveKernelScalar(const MoveLanes &lanes, size_t begin, size_t end);
+size_t MoveKernelSse2(const MoveLanes &lanes, size_t count);
+size_t MoveKernelAvx2(const MoveLanes &lanes, size_t count);
@@ -0,0 +1,72 @@
+// Built with AVX2 code generation on x86, see CMakeLists.txt. Only called after
+// BatchSim has checked the CPU, so the rest of chad-core stays baseline x86-64.
+#include "core/batchSim.h"
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+
+bool Avx2KernelCompiled()
+{
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t MoveKernelAvx2(const MoveLanes &lanes, size_t count)
+{
+#if defined(__AVX2__)
+    const __m256i one    = _mm256_set1_epi32(1);
+    const __m256i none   = _mm256_set1_epi32(static_cast<int32_t>(Direction::None));
+    const __m256i up     = _mm256_set1_epi32(static_cast<int32_t>(Direction::Up));
+    const __m256i down   = _mm256_set1_epi32(static_cast<int32_t>(Direction::Down));
+    const __m256i left   = _mm256_set1_epi32(static_cast<int32_t>(Direction::Left));
+    const __m256i right  = _mm256_set1_epi32(static_cast<int32_t>(Direction::Right));
+    const __m256i zero   = _mm256_setzero_si256();
+    const __m256i maxX   = _mm256_set1_epi32(lanes.width - 1);
+    const __m256i maxY   = _mm256_set1_epi32(lanes.height - 1);
+    const __m256i fMoved = _mm256_set1_epi32(MOVE_MOVED);
+    const __m256i fWall  = _mm256_set1_epi32(MOVE_WALL);
+    const __m256i fFruit = _mm256_set1_epi32(MOVE_FRUIT);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d  = _mm256_loadu_si256((const __m256i *)(lanes.dir + i));
+        __m256i in = _mm256_loadu_si256((const __m256i *)(lanes.input + i));
+
+        // take the input unless it is None or the reverse of the heading
+        __m256i reject = _mm256_or_si256(_mm256_cmpeq_epi32(in, none),
+                                         _mm256_cmpeq_epi32(in, _mm256_xor_si256(d, one)));
+        d              = _mm256_blendv_epi8(in, d, reject);
+        _mm256_storeu_si256((__m256i *)(lanes.dir + i), d);
+
+        // compare masks are -1, so mask(a) - mask(b) is the step along that axis
+        __m256i dx = _mm256_sub_epi32(_mm256_cmpeq_epi32(d, left), _mm256_cmpeq_epi32(d, right));
+        __m256i dy = _mm256_sub_epi32(_mm256_cmpeq_epi32(d, down), _mm256_cmpeq_epi32(d, up));
+        __m256i x  = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(lanes.headX + i)), dx);
+        __m256i y  = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(lanes.headY + i)), dy);
+
+        // AVX2 only has signed greater-than, so x < 0 is 0 > x
+        __m256i moved = _mm256_andnot_si256(_mm256_cmpeq_epi32(d, none), fMoved);
+        __m256i wall  = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(zero, x), _mm256_cmpgt_epi32(x, maxX)),
+                                       _mm256_or_si256(_mm256_cmpgt_epi32(zero, y), _mm256_cmpgt_epi32(y, maxY)));
+        __m256i fruit =
+            _mm256_and_si256(_mm256_cmpeq_epi32(x, _mm256_loadu_si256((const __m256i *)(lanes.fruitX + i))),
+                             _mm256_cmpeq_epi32(y, _mm256_loadu_si256((const __m256i *)(lanes.fruitY + i))));
+
+        __m256i flags = _mm256_or_si256(
+            moved, _mm256_or_si256(_mm256_and_si256(wall, fWall), _mm256_and_si256(fruit, fFruit)));
+
+        _mm256_storeu_si256((__m256i *)(lanes.nextX + i), x);
+        _mm256_storeu_si256((__m256i *)(lanes.nextY + i), y);
+        _mm256_storeu_si256((__m256i *)(lanes.flags + i), flags);
+    }
+    return i;
+#else
+    (void)lanes;
+    (void)count;
+    return 0;
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+inline int Popcount64(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// position of the n-th set bit (0-based) of word, which must have more than n bits set
+inline int SelectBit64(uint64_t word, int n)
+{
+    // skip whole bytes, then clear the lowest set bits that remain
+    int base = 0;
+    while (true) {
+        int inByte = Popcount64(word & 0xff);
+        if (n < inByte) {
+            break;
+        }
+        n -= inByte;
+        word >>= 8;
+        base += 8;
+    }
+    for (; n > 0; n--) {
+        word &= word - 1;
+    }
+
+    int bit = 0;
+    while (!((word >> bit) & 1)) {
+        bit++;
+    }
+    return base + bit;
+}
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+
+#include "core/fixedStep.h"
+
+FixedStepScheduler::FixedStepScheduler(int maxTicksPerFrame, double maxFrameTime)
+    : maxTicksPerFrame(maxTicksPerFrame)
+    , maxFrameTime(maxFrameTime)
+{
+}
+
+void FixedStepScheduler::Reset()
+{
+    accumulator    = 0.0;
+    ticksThisFrame = 0;
+}
+
+void FixedStepScheduler::Advance(double frameTime)
+{
+    // a long hitch (debugger, window drag) must not turn into a burst of ticks
+    accumulator += std::clamp(frameTime, 0.0, maxFrameTime);
+    ticksThisFrame = 0;
+}
+
+bool FixedStepScheduler::Consume(double interval)
+{
+    if (interval <= 0.0 || accumulator < interval) {
+        return false;
+    }
+
+    // spiral-of-death guard: if ticks cost more than they simulate we would fall
+    // further behind every frame, so give up on the backlog and keep the remainder
+    if (ticksThisFrame >= maxTicksPerFrame) {
+        droppedTicks += static_cast<uint64_t>(accumulator / interval);
+        accumulator = std::fmod(accumulator, interval);
+        return false;
+    }
+
+    accumulator -= interval;
+    ticksThisFrame++;
+    ticks++;
+    return true;
+}
+
+double FixedStepScheduler::TimeToNextTick(double interval) const
+{
+    return std::max(interval - accumulator, 0.0);
+}
+
+float FixedStepScheduler::Alpha(double interval) const
+{
+    if (interval <= 0.0) {
+        return 1.0f;
+    }
+    return static_cast<float>(std::clamp(accumulator / interval, 0.0, 1.0));
+}
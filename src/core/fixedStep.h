@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// Accumulates real frame time and hands it out in whole simulation ticks, so the
+// tick rate is set by the tick interval alone and not by how fast frames arrive.
+// Leftover time carries over to the next frame instead of being dropped.
+//
+// The interval is passed per tick because the game speeds up as it goes; it comes
+// from the simulation state, so a given input sequence always sees the same ticks.
+//
+//     scheduler.Advance(frameTime);
+//     while (scheduler.Consume(game.snakeSpeed)) {
+//         Step(game, input);
+//     }
+//     float alpha = scheduler.Alpha(game.snakeSpeed);
+class FixedStepScheduler
+{
+public:
+    // maxTicksPerFrame and maxFrameTime bound the catch-up work after a stall
+    explicit FixedStepScheduler(int maxTicksPerFrame = 5, double maxFrameTime = 0.25);
+
+    // forgets accumulated time, e.g. when a game starts or is paused
+    void Reset();
+
+    // adds one frame of real time, clamped to maxFrameTime
+    void Advance(double frameTime);
+
+    // true when a tick of interval seconds is due, which is then taken from the
+    // accumulator. Once the per-frame cap is hit the backlog is dropped instead.
+    bool Consume(double interval);
+
+    // seconds until Consume(interval) would next succeed, 0 when a tick is already due
+    double TimeToNextTick(double interval) const;
+
+    // progress towards the next tick in [0, 1], for interpolating between ticks
+    float Alpha(double interval) const;
+
+    uint64_t Ticks() const { return ticks; }
+
+    // ticks skipped by the spiral-of-death guard
+    uint64_t DroppedTicks() const { return droppedTicks; }
+
+private:
+    int      maxTicksPerFrame;
+    double   maxFrameTime;
+    double   accumulator    = 0.0;
+    int      ticksThisFrame = 0;
+    uint64_t ticks          = 0;
+    uint64_t droppedTicks   = 0;
+};
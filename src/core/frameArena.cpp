@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+#include "core/frameArena.h"
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : block(new unsigned char[initialCapacity])
+    , capacity(initialCapacity)
+{
+}
+
+void *FrameArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t base    = reinterpret_cast<uintptr_t>(block.get());
+    size_t    aligned = ((base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+    if (aligned + size <= capacity) {
+        used = aligned + size;
+        return block.get() + aligned;
+    }
+
+    // too big for what is left; the next Reset() grows the block to fit this frame
+    overflow.emplace_back(new unsigned char[size + alignment]);
+    overflowBytes += size + alignment;
+    uintptr_t extra = reinterpret_cast<uintptr_t>(overflow.back().get());
+    return reinterpret_cast<void *>((extra + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+
+std::string_view FrameArena::Format(const char *format, ...)
+{
+    // write straight into the rest of the block, and again into a new allocation
+    // only when it did not fit
+    va_list args;
+    va_start(args, format);
+    size_t available = capacity - std::min(capacity, used);
+    char  *text      = reinterpret_cast<char *>(block.get() + used);
+    int    length    = std::vsnprintf(available > 0 ? text : nullptr, available, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return std::string_view();
+    }
+    if (static_cast<size_t>(length) < available) {
+        used += length + 1;
+        return std::string_view(text, length);
+    }
+
+    text = static_cast<char *>(Allocate(length + 1, 1));
+    va_start(args, format);
+    std::vsnprintf(text, length + 1, format, args);
+    va_end(args);
+    return std::string_view(text, length);
+}
+
+void FrameArena::Reset()
+{
+    highWater = std::max(highWater, Used());
+    if (!overflow.empty()) {
+        capacity = std::max(capacity * 2, highWater);
+        block.reset(new unsigned char[capacity]);
+        overflow.clear();
+        overflowBytes = 0;
+    }
+    used = 0;
+}
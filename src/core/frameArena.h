@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Linear allocator for data that lives for one frame, such as formatted text.
+// Allocating bumps an offset into one preallocated block and Reset() at the start
+// of the next frame takes it all back at once, so steady-state frames do not touch
+// the heap. A frame that needs more than the block gets extra blocks from the
+// heap, and the next Reset() replaces everything with one block big enough for
+// that frame.
+class FrameArena
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+
+    // memory for this frame, uninitialized
+    void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template<typename T>
+    T *AllocateArray(size_t count)
+    {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // printf into the arena, valid until Reset()
+    std::string_view Format(const char *format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    void Reset();
+
+    size_t Used() const { return used + overflowBytes; }
+    size_t Capacity() const { return capacity; }
+    size_t HighWater() const { return highWater; }
+
+private:
+    std::unique_ptr<unsigned char[]>              block;
+    size_t                                        capacity      = 0;
+    size_t                                        used          = 0;
+    size_t                                        highWater     = 0;
+    size_t                                        overflowBytes = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+};
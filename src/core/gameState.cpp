@@ -0,0 +1,101 @@
+#include "core/gameState.h"
+
+GameState::GameState(int gridWidth, int gridHeight)
+    : width(gridWidth)
+    , height(gridHeight)
+    , snake(gridWidth, gridHeight)
+{
+}
+
+void ResetGame(GameState &state, uint64_t seed)
+{
+    // vertically centred, which is row 10 on the default board
+    int row = state.height / 2;
+    state.snake.Reset({Vec2i(5, row), Vec2i(4, row), Vec2i(3, row)});
+    state.snakeDir   = Direction::None;
+    state.score      = 0;
+    state.gameOver   = false;
+    state.gameWon    = false;
+    state.snakeSpeed = UPDATE_INTERVAL;
+    state.tick       = 0;
+    state.rng.Seed(seed);
+
+    SpawnFruit(state);
+}
+
+void ApplyInput(GameState &state, Direction input)
+{
+    if (input != Direction::None && state.snakeDir != Reverse(input)) {
+        state.snakeDir = input;
+    }
+}
+
+bool Step(GameState &state, Direction input)
+{
+    if (state.gameOver) {
+        return false;
+    }
+
+    ApplyInput(state, input);
+
+    if (state.snakeDir == Direction::None) {
+        return false;
+    }
+
+    // move snake
+    Vec2i newHead = Neighbour(state.snake.Head(), state.snakeDir);
+
+    state.tick++;
+
+    // wall collision
+    if (newHead.x < 0 || newHead.x >= state.width || newHead.y < 0 || newHead.y >= state.height) {
+        state.gameOver = true;
+        return true;
+    }
+
+    // self collision, the tail has not moved yet so it still counts
+    if (state.snake.Occupied(newHead)) {
+        state.gameOver = true;
+        return true;
+    }
+
+    // fruit collision
+    if (newHead == state.fruit) {
+        state.snake.PushHead(newHead);
+        state.score += 10;
+        SpawnFruit(state);
+
+        // speed increase every 5 fruits
+        if (state.score % 50 == 0 && state.snakeSpeed > 0.05f) {
+            state.snakeSpeed -= 0.01f;
+        }
+    } else {
+        // the tail goes first so a plain move never finds the ring full,
+        // only a snake that gets longer grows it
+        state.snake.PopTail();
+        state.snake.PushHead(newHead);
+    }
+
+    return true;
+}
+
+bool Blocked(const GameState &state, Direction direction)
+{
+    Vec2i next = Neighbour(state.snake.Head(), direction);
+    return next.x < 0 || next.x >= state.width || next.y < 0 || next.y >= state.height || state.snake.Occupied(next);
+}
+
+void SpawnFruit(GameState &state)
+{
+    // the snake covers the whole board, nothing left to eat
+    const OccupancyGrid &occupancy = state.snake.Occupancy();
+    if (occupancy.FreeCount() == 0) {
+        state.gameWon  = true;
+        state.gameOver = true;
+        return;
+    }
+
+    // the n-th free cell in row-major order
+    uint32_t slot = state.rng.NextBelow(static_cast<uint32_t>(occupancy.FreeCount()));
+    state.fruit   = occupancy.NthFree(slot);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/rng.h"
+#include "core/snakeBody.h"
+#include "core/vec.h"
+
+// Game constants
+const int   GRID_WIDTH      = 20;
+const int   GRID_HEIGHT     = 20;
+const float UPDATE_INTERVAL = 0.15f;  // seconds
+const int   MIN_GRID_SIZE   = 8;      // room for the starting snake
+const int   MAX_GRID_SIZE   = 4096;
+
+enum class Direction
+{
+    Up,
+    Down,
+    Left,
+    Right,
+    None
+};
+
+// the cell one step from cell, direction must not be None
+inline Vec2i Neighbour(const Vec2i &cell, Direction direction)
+{
+    static const int DIRECTION_X[4] = {0, 0, -1, 1};
+    static const int DIRECTION_Y[4] = {1, -1, 0, 0};
+    return Vec2i(cell.x + DIRECTION_X[static_cast<int>(direction)], cell.y + DIRECTION_Y[static_cast<int>(direction)]);
+}
+
+// the heading straight back, direction must not be None
+inline Direction Reverse(Direction direction)
+{
+    static const Direction REVERSE[4] = {Direction::Down, Direction::Up, Direction::Right, Direction::Left};
+    return REVERSE[static_cast<int>(direction)];
+}
+
+// Complete simulation state of one game. Contains no GL or window handles, and
+// everything that affects the outcome, including the RNG, lives here, so two
+// copies stepped with the same inputs stay identical.
+struct GameState
+{
+    GameState(int gridWidth = GRID_WIDTH, int gridHeight = GRID_HEIGHT);
+
+    int       width;
+    int       height;
+    SnakeBody snake;
+    Vec2i     fruit;
+    Direction snakeDir   = Direction::None;
+    int       score      = 0;
+    bool      gameOver   = false;
+    bool      gameWon    = false;
+    float     snakeSpeed = UPDATE_INTERVAL;  // seconds per tick
+    uint64_t  tick       = 0;
+    Rng       rng;
+};
+
+// Puts the starting snake back and places the first fruit from seed
+void ResetGame(GameState &state, uint64_t seed);
+
+// Turns towards input unless that would reverse onto the body, None keeps the heading
+void ApplyInput(GameState &state, Direction input);
+
+// Applies input and advances one tick, returns false when the state did not change
+bool Step(GameState &state, Direction input);
+
+// True when moving that way next tick would end the game on a wall or the body
+bool Blocked(const GameState &state, Direction direction);
+
+// Places the fruit on a random free cell, or ends the game as won when none is left
+void SpawnFruit(GameState &state);
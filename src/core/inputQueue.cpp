@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "core/inputQueue.h"
+
+static_assert((InputQueue::CAPACITY & (InputQueue::CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+InputQueue::InputQueue(size_t depth)
+{
+    SetDepth(depth);
+}
+
+void InputQueue::SetDepth(size_t newDepth)
+{
+    depth = std::clamp<size_t>(newDepth, 1, CAPACITY);
+}
+
+bool InputQueue::Push(const InputEvent &event)
+{
+    uint32_t back = tail.load(std::memory_order_relaxed);
+    if (back - head.load(std::memory_order_acquire) >= depth) {
+        return false;
+    }
+
+    events[back & (CAPACITY - 1)] = event;
+    tail.store(back + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::Pop(InputEvent &event)
+{
+    uint32_t front = head.load(std::memory_order_relaxed);
+    if (front == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    event = events[front & (CAPACITY - 1)];
+    head.store(front + 1, std::memory_order_release);
+    return true;
+}
+
+void InputQueue::Clear()
+{
+    head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+static bool IsTurn(Direction heading, Direction input)
+{
+    if (input == Direction::None || input == heading) {
+        return false;
+    }
+
+    // Up/Down and Left/Right differ only in bit 0
+    return heading == Direction::None || static_cast<int>(input) != (static_cast<int>(heading) ^ 1);
+}
+
+bool PopTurn(InputQueue &queue, Direction heading, InputEvent &event)
+{
+    while (queue.Pop(event)) {
+        if (IsTurn(heading, event.direction)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/gameState.h"
+
+struct InputEvent
+{
+    Direction direction = Direction::None;
+    uint64_t  time      = 0;  // steady_clock nanoseconds when the press was seen
+};
+
+// Bounded single-producer/single-consumer queue of direction presses. The key
+// handler pushes and the tick pops, so quick presses between two ticks are
+// applied on consecutive ticks instead of overwriting each other. Indices only
+// grow and are masked, and each side writes one of them, so the two ends may run
+// on different threads without a lock.
+class InputQueue
+{
+public:
+    static constexpr size_t CAPACITY = 16;
+
+    explicit InputQueue(size_t depth = 3);
+
+    // how many presses may wait at once, 1..CAPACITY
+    void SetDepth(size_t depth);
+
+    size_t Depth() const { return depth; }
+
+    // producer side, false when Depth() presses are already waiting and this one is dropped
+    bool Push(const InputEvent &event);
+
+    // consumer side
+    bool Pop(InputEvent &event);
+    void Clear();
+
+    size_t Size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+private:
+    std::array<InputEvent, CAPACITY> events;
+    size_t                           depth;
+    std::atomic<uint32_t>            head{0};  // next to pop, written by the consumer
+    std::atomic<uint32_t>            tail{0};  // next to push, written by the producer
+};
+
+// Pops presses until one turns the snake away from heading; presses along or
+// against the heading would be ignored by ApplyInput and are dropped here so
+// they do not use up a tick. Returns false when none is left.
+bool PopTurn(InputQueue &queue, Direction heading, InputEvent &event);
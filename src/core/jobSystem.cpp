@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "core/jobSystem.h"
+
+static_assert((JobDeque::CAPACITY & (JobDeque::CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+static_assert(sizeof(Job) == 128, "a job spans two cache lines");
+
+// failed rounds over every deque before an idle worker goes to sleep
+static const int IDLE_SPINS = 64;
+
+thread_local size_t JobSystem::workerIndex = 0;
+
+// Chase and Lev, "Dynamic Circular Work-Stealing Deque", with the C11 orderings of
+// Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models"
+bool JobDeque::Push(Job *job)
+{
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(CAPACITY)) {
+        return false;
+    }
+
+    // a release store rather than the paper's fence, the same on x86 and visible to ThreadSanitizer
+    ring[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+Job *JobDeque::Pop()
+{
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // the last job may be stolen at the same time, the CAS on top decides
+    Job *job = ring[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job *JobDeque::Steal()
+{
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job *job = ring[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+bool JobDeque::Empty() const
+{
+    return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(size_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        auto worker  = std::make_unique<Worker>();
+        worker->jobs = std::unique_ptr<Job[]>(new Job[JOB_POOL]());
+        for (size_t j = 0; j < JOB_POOL; j++) {
+            worker->jobs[j].unfinished.store(0, std::memory_order_relaxed);
+        }
+        worker->victim = static_cast<uint32_t>(i * 0x9e3779b9u + 1);
+        workers.push_back(std::move(worker));
+    }
+
+    workerIndex = 0;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+// skips jobs still in flight, which only a parent left waiting on its children
+// for a long time can be
+Job *JobSystem::Create(JobFunction function, Job *parent)
+{
+    Worker &worker = *workers[workerIndex];
+    Job    *job    = nullptr;
+    for (size_t tries = 0; tries < JOB_POOL; tries++) {
+        Job &candidate = worker.jobs[worker.nextJob++ & (JOB_POOL - 1)];
+        if (candidate.Finished()) {
+            job = &candidate;
+            break;
+        }
+    }
+    if (!job) {
+        std::cerr << "JobSystem: more than " << JOB_POOL << " jobs in flight on worker " << workerIndex << "\n";
+        std::abort();
+    }
+
+    if (parent) {
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+    job->function     = function;
+    job->parent       = parent;
+    job->continuation = nullptr;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::Run(Job *job)
+{
+    if (!workers[workerIndex]->deque.Push(job)) {
+        Execute(job);
+        return;
+    }
+    WakeOne();
+}
+
+void JobSystem::Wait(const Job *job)
+{
+    while (!job->Finished()) {
+        Job *next = FindJob(workerIndex);
+        if (next) {
+            Execute(next);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+struct ParallelForData
+{
+    size_t begin;
+    size_t end;
+    size_t grain;
+    void (*body)(size_t begin, size_t end, void *context);
+    void *context;
+};
+
+// queues the upper half until the range is down to the grain, then runs what is left
+static void ParallelForJob(JobSystem &system, Job &job)
+{
+    ParallelForData data = job.Data<ParallelForData>();
+    while (data.end - data.begin > data.grain) {
+        ParallelForData upper = data;
+        upper.begin           = data.begin + (data.end - data.begin) / 2;
+        data.end              = upper.begin;
+        system.Run(system.Create(ParallelForJob, upper, &job));
+    }
+    data.body(data.begin, data.end, data.context);
+}
+
+void JobSystem::ParallelFor(size_t count,
+                            size_t grain,
+                            void (*body)(size_t begin, size_t end, void *context),
+                            void *context)
+{
+    if (count == 0) {
+        return;
+    }
+
+    Job *root = Create(ParallelForJob, ParallelForData{0, count, std::max<size_t>(grain, 1), body, context});
+    Run(root);
+    Wait(root);
+}
+
+void JobSystem::WorkerMain(size_t index)
+{
+    workerIndex = index;
+
+    int idle = 0;
+    while (true) {
+        Job *job = FindJob(index);
+        if (job) {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+
+        // announce the sleep before the last look, Run() checks sleeping after pushing
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) {
+            break;
+        }
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!AnyQueued()) {
+            wake.wait(lock, [this] { return signals > 0 || stopping; });
+            if (signals > 0) {
+                signals--;
+            }
+        }
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+// own deque first, newest job first, then the oldest job of the others starting
+// from a random one
+Job *JobSystem::FindJob(size_t index)
+{
+    Worker &worker = *workers[index];
+    if (Job *job = worker.deque.Pop()) {
+        return job;
+    }
+
+    size_t count = workers.size();
+    worker.victim ^= worker.victim << 13;
+    worker.victim ^= worker.victim >> 17;
+    worker.victim ^= worker.victim << 5;
+    size_t first = worker.victim % count;
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (first + i) % count;
+        if (victim == index) {
+            continue;
+        }
+        if (Job *job = workers[victim]->deque.Steal()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobSystem::AnyQueued() const
+{
+    for (const auto &worker : workers) {
+        if (!worker->deque.Empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job *job)
+{
+    job->function(*this, *job);
+    Finish(job);
+}
+
+// parent and continuation are read first, the job may be reused once it is done
+void JobSystem::Finish(Job *job)
+{
+    Job *parent       = job->parent;
+    Job *continuation = job->continuation;
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (continuation) {
+        Run(continuation);
+    }
+    if (parent) {
+        Finish(parent);
+    }
+}
+
+void JobSystem::WakeOne()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (signals < sleeping.load(std::memory_order_relaxed)) {
+            signals++;
+        }
+    }
+    wake.notify_one();
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class JobSystem;
+struct Job;
+
+using JobFunction = void (*)(JobSystem &system, Job &job);
+
+// A unit of work with a small inline payload. A job counts as finished once its
+// function has returned and all of its children have finished; its continuation
+// is then run, and its parent is one child closer to finishing.
+struct alignas(64) Job
+{
+    static constexpr size_t DATA_SIZE = 96;
+
+    JobFunction          function;
+    Job                 *parent;
+    Job                 *continuation;
+    std::atomic<int32_t> unfinished;  // the job itself plus its unfinished children
+
+    template<typename T>
+    T &Data()
+    {
+        static_assert(sizeof(T) <= DATA_SIZE, "job data too large");
+        return *reinterpret_cast<T *>(data);
+    }
+
+    bool Finished() const { return unfinished.load(std::memory_order_acquire) == 0; }
+
+    alignas(16) unsigned char data[DATA_SIZE];
+};
+
+// Bounded Chase-Lev deque. The owning worker pushes and pops at the bottom, so it
+// works depth first on what it just split off; thieves take from the top, where
+// the oldest and usually biggest pieces of work are.
+class JobDeque
+{
+public:
+    static constexpr size_t CAPACITY = 4096;
+
+    // owner side, false when full
+    bool Push(Job *job);
+    Job *Pop();
+
+    // any thread
+    Job *Steal();
+    bool Empty() const;
+
+private:
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Job *>               ring[CAPACITY];
+};
+
+// Work-stealing thread pool. The thread that creates it is worker 0 and works
+// through jobs while it waits in Wait(); the others idle on a condition variable
+// once every deque is empty. Jobs come from a ring per worker and are reused
+// after JOB_POOL more have been created on the same worker, so neither Create()
+// nor Run() allocates, and no more than that many may be in flight per worker.
+//
+// Jobs may be created and run from the creating thread and from inside jobs.
+class JobSystem
+{
+public:
+    static constexpr size_t JOB_POOL = 4096;
+
+    // threadCount 0 uses every hardware thread
+    explicit JobSystem(size_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &)            = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    size_t WorkerCount() const { return workers.size(); }
+
+    // 0 for the creating thread, 1.. for the pool's own, for per-worker scratch state
+    static size_t WorkerIndex() { return workerIndex; }
+
+    // a child keeps its parent from finishing until it has finished itself
+    Job *Create(JobFunction function, Job *parent = nullptr);
+
+    template<typename T>
+    Job *Create(JobFunction function, const T &data, Job *parent = nullptr)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "job data is copied bytewise");
+        static_assert(sizeof(T) <= Job::DATA_SIZE, "job data too large");
+        Job *job = Create(function, parent);
+        std::memcpy(job->data, &data, sizeof(T));
+        return job;
+    }
+
+    // queues continuation once job has finished; set before running job
+    void Then(Job *job, Job *continuation) { job->continuation = continuation; }
+
+    // queues the job on the calling worker's deque, or runs it at once when that is full
+    void Run(Job *job);
+
+    // runs queued jobs on the calling thread until job has finished
+    void Wait(const Job *job);
+
+    // calls body(begin, end, context) over [0, count) in ranges of about grain,
+    // split in halves so that idle workers steal big pieces first
+    void ParallelFor(size_t count, size_t grain, void (*body)(size_t begin, size_t end, void *context), void *context);
+
+private:
+    struct Worker
+    {
+        JobDeque               deque;
+        std::unique_ptr<Job[]> jobs;
+        size_t                 nextJob = 0;
+        uint32_t               victim  = 0;  // xorshift state for picking whom to steal from
+    };
+
+    void WorkerMain(size_t index);
+    Job *FindJob(size_t index);
+    bool AnyQueued() const;
+    void Execute(Job *job);
+    void Finish(Job *job);
+    void WakeOne();
+
+    static thread_local size_t workerIndex;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    // idle workers sleep here; signals counts wake-ups not yet taken
+    std::mutex              sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t>     sleeping{0};
+    size_t                  signals  = 0;
+    bool                    stopping = false;
+};
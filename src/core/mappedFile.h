@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only view of a whole file. Mapped where the platform allows, so scanning
+// a large archive only pages in what is actually read.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // false if the file cannot be opened; empty files open with Size() == 0
+    bool Open(const std::string &path);
+    void Close();
+
+    const uint8_t *Data() const { return data; }
+
+    size_t Size() const { return size; }
+
+private:
+    const uint8_t *data = nullptr;
+    size_t         size = 0;
+
+#if defined(_WIN32)
+    void *file    = nullptr;
+    void *mapping = nullptr;
+#endif
+};
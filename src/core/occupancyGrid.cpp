@@ -0,0 +1,90 @@
+#include <algorithm>
+
+#include "core/bits.h"
+#include "core/occupancyGrid.h"
+
+OccupancyGrid::OccupancyGrid(int gridWidth, int gridHeight)
+    : width(static_cast<uint32_t>(gridWidth))
+    , freeCount(static_cast<size_t>(gridWidth) * gridHeight)
+    , words((freeCount + 63) / 64, 0)
+{
+    // bits past the last cell count as occupied, so they are never picked
+    if (freeCount % 64) {
+        words.back() = ~uint64_t(0) << (freeCount % 64);
+    }
+
+    size_t blocks = (words.size() + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    blockTree.assign(blocks + 1, 0);
+    for (size_t block = 0; block < blocks; block++) {
+        size_t first = block * BLOCK_WORDS * 64;
+        size_t last  = std::min(first + BLOCK_WORDS * 64, freeCount);
+        blockTree[block + 1] += static_cast<uint32_t>(last - first);
+
+        // linear-time build, each node passes its sum on to its parent
+        size_t parent = (block + 1) + ((block + 1) & (~(block + 1) + 1));
+        if (parent <= blocks) {
+            blockTree[parent] += blockTree[block + 1];
+        }
+    }
+
+    treeTop = 1;
+    while (treeTop * 2 <= blocks) {
+        treeTop *= 2;
+    }
+}
+
+void OccupancyGrid::Set(const Vec2i &cell)
+{
+    size_t   bit  = CellIndex(cell);
+    uint64_t mask = uint64_t(1) << (bit & 63);
+    if (words[bit >> 6] & mask) {
+        return;
+    }
+
+    words[bit >> 6] |= mask;
+    AddFree((bit >> 6) / BLOCK_WORDS, -1);
+}
+
+void OccupancyGrid::Clear(const Vec2i &cell)
+{
+    size_t   bit  = CellIndex(cell);
+    uint64_t mask = uint64_t(1) << (bit & 63);
+    if (!(words[bit >> 6] & mask)) {
+        return;
+    }
+
+    words[bit >> 6] &= ~mask;
+    AddFree((bit >> 6) / BLOCK_WORDS, 1);
+}
+
+Vec2i OccupancyGrid::NthFree(size_t n) const
+{
+    // find the block holding the n-th free cell, n becomes the index inside it
+    size_t block = 0;
+    for (size_t step = treeTop; step > 0; step >>= 1) {
+        if (block + step < blockTree.size() && blockTree[block + step] <= n) {
+            block += step;
+            n -= blockTree[block];
+        }
+    }
+
+    size_t word = block * BLOCK_WORDS;
+    while (true) {
+        uint64_t free   = ~words[word];
+        size_t   inWord = static_cast<size_t>(Popcount64(free));
+        if (n < inWord) {
+            size_t cell = word * 64 + SelectBit64(free, static_cast<int>(n));
+            return Vec2i(static_cast<int>(cell % width), static_cast<int>(cell / width));
+        }
+        n -= inWord;
+        word++;
+    }
+}
+
+void OccupancyGrid::AddFree(size_t block, int delta)
+{
+    freeCount += delta;
+    for (size_t i = block + 1; i < blockTree.size(); i += i & (~i + 1)) {
+        blockTree[i] += delta;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/vec.h"
+
+// Occupied grid cells as a bitmap, one bit per cell, with the number of free
+// cells per block of 4096 kept in a Fenwick tree. Testing or changing a cell is
+// O(1) plus a tree update, and the n-th free cell in row-major order is found by
+// descending the tree and scanning one block, so picking a random free cell costs
+// the same on a 20x20 board as on a 4096x4096 one, which needs about 2 MB.
+class OccupancyGrid
+{
+public:
+    OccupancyGrid(int gridWidth, int gridHeight);
+
+    bool Test(const Vec2i &cell) const
+    {
+        size_t bit = CellIndex(cell);
+        return (words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    void Set(const Vec2i &cell);
+    void Clear(const Vec2i &cell);
+
+    size_t FreeCount() const { return freeCount; }
+
+    // n-th free cell counted in row-major order, n must be below FreeCount()
+    Vec2i NthFree(size_t n) const;
+
+private:
+    static constexpr size_t BLOCK_WORDS = 64;
+
+    size_t CellIndex(const Vec2i &cell) const { return static_cast<size_t>(cell.y) * width + cell.x; }
+
+    void AddFree(size_t block, int delta);
+
+    uint32_t              width;
+    size_t                freeCount;
+    size_t                treeTop;  // highest power of two not above the block count
+    std::vector<uint64_t> words;
+    std::vector<uint32_t> blockTree;  // Fenwick tree over free cells per block, 1-based
+};
@@ -0,0 +1,223 @@
+#include <algorithm>
+
+#include "core/replay.h"
+
+static void PutU16(uint8_t *out, uint16_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void PutU32(uint8_t *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static void PutU64(uint8_t *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint16_t GetU16(const uint8_t *in)
+{
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t *in)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t GetU64(const uint8_t *in)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void ReplayRecorder::Begin(uint64_t seed, const GameState &state)
+{
+    header        = ReplayHeader();
+    header.seed   = seed;
+    header.width  = state.width;
+    header.height = state.height;
+    events.clear();
+    lastTick = 0;
+    active   = true;
+}
+
+void ReplayRecorder::Record(uint64_t tick, Direction input)
+{
+    if (!active || input == Direction::None) {
+        return;
+    }
+
+    // most turns are a few ticks apart, so this is usually a single byte
+    uint64_t value = (static_cast<uint64_t>(static_cast<uint32_t>(tick) - lastTick) << 2)
+                   | static_cast<uint64_t>(input);
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        events.push_back(value ? byte | 0x80 : byte);
+    } while (value);
+
+    lastTick = static_cast<uint32_t>(tick);
+    header.eventCount++;
+}
+
+void ReplayRecorder::Finish(const GameState &state, std::vector<uint8_t> &out)
+{
+    header.flags      = state.gameOver ? REPLAY_FINISHED : 0;
+    header.tickCount  = static_cast<uint32_t>(state.tick);
+    header.finalScore = static_cast<uint32_t>(state.score);
+    header.eventBytes = static_cast<uint32_t>(events.size());
+
+    uint8_t bytes[REPLAY_HEADER_SIZE] = {};
+    PutU32(bytes + 0, REPLAY_MAGIC);
+    PutU16(bytes + 4, REPLAY_VERSION);
+    PutU16(bytes + 6, header.flags);
+    PutU64(bytes + 8, header.seed);
+    PutU16(bytes + 16, static_cast<uint16_t>(header.width));
+    PutU16(bytes + 18, static_cast<uint16_t>(header.height));
+    bytes[20] = static_cast<uint8_t>(header.startDirection);
+    PutU32(bytes + 24, header.tickCount);
+    PutU32(bytes + 28, header.finalScore);
+    PutU32(bytes + 32, header.eventCount);
+    PutU32(bytes + 36, header.eventBytes);
+
+    out.insert(out.end(), bytes, bytes + REPLAY_HEADER_SIZE);
+    out.insert(out.end(), events.begin(), events.end());
+    active = false;
+}
+
+ReplayReader::ReplayReader(const uint8_t *data, size_t size)
+    : data(data)
+    , size(size)
+{
+}
+
+bool ReplayReader::Next(ReplayHeader &header, const uint8_t *&events)
+{
+    if (error || offset == size) {
+        return false;
+    }
+
+    const uint8_t *record = data + offset;
+    if (size - offset < REPLAY_HEADER_SIZE || GetU32(record) != REPLAY_MAGIC || GetU16(record + 4) != REPLAY_VERSION) {
+        error = true;
+        return false;
+    }
+
+    header.flags          = GetU16(record + 6);
+    header.seed           = GetU64(record + 8);
+    header.width          = GetU16(record + 16);
+    header.height         = GetU16(record + 18);
+    header.startDirection = static_cast<Direction>(record[20]);
+    header.tickCount      = GetU32(record + 24);
+    header.finalScore     = GetU32(record + 28);
+    header.eventCount     = GetU32(record + 32);
+    header.eventBytes     = GetU32(record + 36);
+
+    // the board is built from the header, so sides outside what the game supports are corrupt
+    bool badGrid = std::min(header.width, header.height) < MIN_GRID_SIZE
+                || std::max(header.width, header.height) > MAX_GRID_SIZE;
+    if (badGrid || record[20] > static_cast<uint8_t>(Direction::None)
+        || size - offset - REPLAY_HEADER_SIZE < header.eventBytes) {
+        error = true;
+        return false;
+    }
+
+    events = record + REPLAY_HEADER_SIZE;
+    offset += REPLAY_HEADER_SIZE + header.eventBytes;
+    return true;
+}
+
+ReplayEventCursor::ReplayEventCursor(const uint8_t *events, size_t bytes)
+    : current(events)
+    , end(events + bytes)
+{
+}
+
+bool ReplayEventCursor::Next(ReplayEvent &event)
+{
+    uint64_t value = 0;
+    int      shift = 0;
+    while (true) {
+        if (current == end || shift > 35) {
+            return false;
+        }
+        uint8_t byte = *current++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    tick += static_cast<uint32_t>(value >> 2);
+    event.tick  = tick;
+    event.input = static_cast<Direction>(value & 3);
+    return true;
+}
+
+bool PlayReplay(const ReplayHeader &header, const uint8_t *events, GameState &state)
+{
+    ResetGame(state, header.seed);
+    state.snakeDir = header.startDirection;
+
+    ReplayEventCursor cursor(events, header.eventBytes);
+    ReplayEvent       event;
+    uint32_t          decoded = 0;
+
+    // every tick Step advances the counter, so the events line up with state.tick
+    bool hasEvent = cursor.Next(event);
+    while (state.tick < header.tickCount && !state.gameOver) {
+        Direction input = Direction::None;
+        if (hasEvent && event.tick == state.tick) {
+            input    = event.input;
+            hasEvent = cursor.Next(event);
+            decoded++;
+        }
+        if (!Step(state, input)) {
+            break;
+        }
+    }
+
+    return decoded == header.eventCount;
+}
+
+bool ReplayMatches(const ReplayHeader &header, const GameState &state)
+{
+    return state.tick == header.tickCount && static_cast<uint32_t>(state.score) == header.finalScore
+        && state.gameOver == ((header.flags & REPLAY_FINISHED) != 0);
+}
+
+ReplayPlayer::ReplayPlayer(const ReplayHeader &header, const uint8_t *events)
+    : cursor(events, header.eventBytes)
+{
+    hasNext = cursor.Next(next);
+}
+
+Direction ReplayPlayer::InputFor(uint64_t tick)
+{
+    // skip anything older, so a late start does not replay stale turns
+    while (hasNext && next.tick < tick) {
+        hasNext = cursor.Next(next);
+    }
+    if (hasNext && next.tick == tick) {
+        Direction input = next.input;
+        hasNext         = cursor.Next(next);
+        return input;
+    }
+    return Direction::None;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/gameState.h"
+
+// Replay archives are a plain concatenation of records, one per game:
+//
+//   header  40 bytes, little endian, see ReplayHeader
+//   events  eventBytes bytes of LEB128 varints, (tick delta << 2) | direction
+//
+// A tick's input is the direction passed to Step for that tick; ticks without
+// an event step with Direction::None. Records are self-delimiting, so archives
+// can be appended to, streamed, or memory-mapped and scanned header by header
+// without decoding events.
+const uint32_t REPLAY_MAGIC       = 0x50525343;  // "CSRP"
+const uint16_t REPLAY_VERSION     = 2;           // 2: fruit goes to the n-th free cell in row-major order
+const size_t   REPLAY_HEADER_SIZE = 40;
+
+// header flags
+const uint16_t REPLAY_FINISHED = 1;  // the game reached game over
+
+struct ReplayHeader
+{
+    uint64_t  seed           = 0;
+    int       width          = GRID_WIDTH;
+    int       height         = GRID_HEIGHT;
+    Direction startDirection = Direction::None;  // heading set when the player started
+    uint16_t  flags          = 0;
+    uint32_t  tickCount      = 0;
+    uint32_t  finalScore     = 0;
+    uint32_t  eventCount     = 0;
+    uint32_t  eventBytes     = 0;
+};
+
+struct ReplayEvent
+{
+    uint32_t  tick;
+    Direction input;
+};
+
+// Builds one record in memory while a game is played, encoding events as they arrive
+class ReplayRecorder
+{
+public:
+    // call right after ResetGame(state, seed)
+    void Begin(uint64_t seed, const GameState &state);
+
+    // the heading the game was started with, applied before the first tick
+    void SetStartDirection(Direction direction) { header.startDirection = direction; }
+
+    // input handed to Step at tick, None is not stored
+    void Record(uint64_t tick, Direction input);
+
+    // appends the finished record, header and events, to out
+    void Finish(const GameState &state, std::vector<uint8_t> &out);
+
+    bool Active() const { return active; }
+
+private:
+    ReplayHeader         header;
+    std::vector<uint8_t> events;
+    uint32_t             lastTick = 0;
+    bool                 active   = false;
+};
+
+// Walks the records of an archive held in memory, e.g. a MappedFile, without copying
+class ReplayReader
+{
+public:
+    ReplayReader(const uint8_t *data, size_t size);
+
+    // parses the next header, events points at its encoded events;
+    // false at the end of the archive or on a malformed record, see Error(); a
+    // board outside MIN_GRID_SIZE..MAX_GRID_SIZE per side counts as malformed
+    bool Next(ReplayHeader &header, const uint8_t *&events);
+
+    bool Error() const { return error; }
+
+    size_t Offset() const { return offset; }
+
+private:
+    const uint8_t *data;
+    size_t         size;
+    size_t         offset = 0;
+    bool           error  = false;
+};
+
+// Decodes the events of one record in order
+class ReplayEventCursor
+{
+public:
+    ReplayEventCursor(const uint8_t *events, size_t bytes);
+
+    // false when all events are read or the data is malformed
+    bool Next(ReplayEvent &event);
+
+private:
+    const uint8_t *current;
+    const uint8_t *end;
+    uint32_t       tick = 0;
+};
+
+// Plays a record headless from ResetGame, as fast as Step runs. Returns false if
+// the events are malformed; state holds the final position either way.
+bool PlayReplay(const ReplayHeader &header, const uint8_t *events, GameState &state);
+
+// true when state is where the header says the recorded game ended
+bool ReplayMatches(const ReplayHeader &header, const GameState &state);
+
+// Feeds a record's inputs one tick at a time, for real-time playback
+class ReplayPlayer
+{
+public:
+    ReplayPlayer(const ReplayHeader &header, const uint8_t *events);
+
+    // the input for tick, ticks must be asked for in increasing order
+    Direction InputFor(uint64_t tick);
+
+private:
+    ReplayEventCursor cursor;
+    ReplayEvent       next;
+    bool              hasNext;
+};
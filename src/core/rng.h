@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// PCG32 generator. Plain data so game states that embed it copy and compare
+// bit-for-bit, and the same seed gives the same stream on every platform.
+struct Rng
+{
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc   = 0xda3e39cb94b95bdbULL;
+
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        state = 0;
+        inc   = (stream << 1u) | 1u;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        uint64_t old        = state;
+        state               = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot        = static_cast<uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31u));
+    }
+
+    // uniform in [0, bound), bound must be non-zero
+    uint32_t NextBelow(uint32_t bound)
+    {
+        // Lemire's multiply-shift with rejection of the biased low range
+        uint64_t product = static_cast<uint64_t>(Next()) * bound;
+        uint32_t low     = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = (~bound + 1u) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>(Next()) * bound;
+                low     = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+};
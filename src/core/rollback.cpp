@@ -0,0 +1,110 @@
+#include <algorithm>
+
+#include "core/rollback.h"
+
+RollbackSession::RollbackSession(int width, int height, uint64_t seed, int player)
+    : localPlayer(player)
+    , remotePlayer(1 - player)
+{
+    ResetVersus(state, width, height, seed);
+    for (uint64_t &remoteTick : remoteTicks) {
+        remoteTick = NO_TICK;
+    }
+}
+
+void RollbackSession::Advance(Direction localInput)
+{
+    Synchronize();
+
+    Frame &frame              = frames[tick % MAX_ROLLBACK];
+    frame.start               = state;
+    frame.inputs[localPlayer] = localInput;
+
+    uint64_t slot              = tick % INPUT_RING;
+    frame.inputs[remotePlayer] = remoteTicks[slot] == tick ? remoteInputs[slot] : Direction::None;
+
+    StepVersus(state, frame.inputs);
+    tick++;
+}
+
+void RollbackSession::ReceiveRemote(uint64_t remoteTick, Direction input)
+{
+    uint64_t slot = remoteTick % INPUT_RING;
+    if (remoteTick < confirmed || remoteTick >= confirmed + INPUT_RING || remoteTicks[slot] == remoteTick) {
+        stats.droppedInputs++;
+        return;
+    }
+    remoteInputs[slot] = input;
+    remoteTicks[slot]  = remoteTick;
+
+    // already simulated with a guess, which is replayed at the next Advance() if wrong
+    if (remoteTick < tick) {
+        Frame &frame = frames[remoteTick % MAX_ROLLBACK];
+        if (frame.inputs[remotePlayer] != input) {
+            frame.inputs[remotePlayer] = input;
+            rollbackFrom               = std::min(rollbackFrom, remoteTick);
+            stats.mispredictions++;
+        }
+    }
+
+    while (remoteTicks[confirmed % INPUT_RING] == confirmed) {
+        confirmed++;
+    }
+}
+
+void RollbackSession::Resimulate(uint64_t fromTick)
+{
+    // frames[fromTick] keeps its start, the later ones are saved again on the way
+    state = frames[fromTick % MAX_ROLLBACK].start;
+    for (uint64_t t = fromTick; t < tick; t++) {
+        Frame &frame = frames[t % MAX_ROLLBACK];
+        if (t != fromTick) {
+            frame.start = state;
+        }
+        StepVersus(state, frame.inputs);
+    }
+
+    stats.rollbacks++;
+    stats.resimulatedTicks += tick - fromTick;
+    stats.deepestRollback = std::max(stats.deepestRollback, tick - fromTick);
+}
+
+void RollbackSession::Synchronize()
+{
+    if (rollbackFrom != NO_TICK) {
+        Resimulate(rollbackFrom);
+        rollbackFrom = NO_TICK;
+    }
+}
+
+LoopbackLink::LoopbackLink(double linkDelay, double linkJitter, uint64_t seed)
+    : delay(linkDelay)
+    , jitter(linkJitter)
+{
+    rng.Seed(seed, 3);
+}
+
+void LoopbackLink::Send(double now, const LinkMessage &message)
+{
+    // uniform in [-jitter, jitter), never before it was sent
+    double offset = jitter * (rng.Next() * (2.0 / 4294967296.0) - 1.0);
+    queue.push_back({std::max(now, now + delay + offset), message});
+}
+
+bool LoopbackLink::Receive(double now, LinkMessage &message)
+{
+    // a handful in flight at a time, a scan is all it takes
+    auto next = queue.end();
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        if (it->deliverAt <= now && (next == queue.end() || it->deliverAt < next->deliverAt)) {
+            next = it;
+        }
+    }
+    if (next == queue.end()) {
+        return false;
+    }
+
+    message = next->message;
+    queue.erase(next);
+    return true;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/rng.h"
+#include "core/versus.h"
+
+struct RollbackStats
+{
+    uint64_t rollbacks        = 0;  // times past ticks were simulated again
+    uint64_t resimulatedTicks = 0;
+    uint64_t deepestRollback  = 0;  // ticks
+    uint64_t mispredictions   = 0;  // remote inputs that differed from the guess
+    uint64_t droppedInputs    = 0;  // outside the window or already known
+};
+
+// One peer of a two-player versus match played over a rollback model. The local
+// player's inputs are applied at once; the remote player's are guessed as None
+// (keep going) until they arrive. Each tick saves the state it started from, and
+// when an arrived input differs from the guess the match goes back to the state
+// before that tick and runs the ticks since again with what is now known. All
+// late inputs that arrive before the next Advance() cost one rollback together.
+//
+// The saved states and inputs sit in fixed rings, so nothing allocates while
+// playing. Rolling back further than MAX_ROLLBACK ticks is not possible:
+// CanAdvance() turns false once the oldest unknown remote input is that old, and
+// the caller waits for the peer instead of advancing.
+class RollbackSession
+{
+public:
+    static constexpr uint64_t MAX_ROLLBACK = 16;  // ticks
+
+    RollbackSession(int width, int height, uint64_t seed, int localPlayer);
+
+    // confirmed runs ahead of tick when the remote peer is ahead of this one
+    bool CanAdvance() const { return tick < confirmed + MAX_ROLLBACK; }
+
+    // simulates tick Tick() with the local input and the remote one as known or
+    // guessed, after catching up on inputs that arrived late; needs CanAdvance()
+    void Advance(Direction localInput);
+
+    // the remote player's input for a tick, in any order; inputs may be up to
+    // MAX_ROLLBACK ticks ahead of this peer
+    void ReceiveRemote(uint64_t remoteTick, Direction input);
+
+    // runs the ticks from fromTick on again, within the last MAX_ROLLBACK;
+    // Advance() does this on its own, public for measuring what it costs
+    void Resimulate(uint64_t fromTick);
+
+    // rolls back now for inputs received since the last Advance()
+    void Synchronize();
+
+    // the next tick to simulate
+    uint64_t Tick() const { return tick; }
+
+    // remote inputs are known for every tick before this one
+    uint64_t Confirmed() const { return confirmed; }
+
+    const VersusState &State() const { return state; }
+
+    const RollbackStats &Stats() const { return stats; }
+
+private:
+    static constexpr uint64_t INPUT_RING = 2 * MAX_ROLLBACK;
+    static constexpr uint64_t NO_TICK    = ~uint64_t(0);
+
+    struct Frame
+    {
+        VersusState start;  // before the tick's inputs
+        Direction   inputs[VERSUS_PLAYERS];
+    };
+
+    int           localPlayer;
+    int           remotePlayer;
+    VersusState   state;
+    uint64_t      tick         = 0;
+    uint64_t      confirmed    = 0;
+    uint64_t      rollbackFrom = NO_TICK;
+    Frame         frames[MAX_ROLLBACK];
+    Direction     remoteInputs[INPUT_RING];
+    uint64_t      remoteTicks[INPUT_RING];  // which tick remoteInputs holds, NO_TICK when none
+    RollbackStats stats;
+};
+
+struct LinkMessage
+{
+    uint64_t  tick;
+    Direction input;
+};
+
+// In-process stand-in for a network connection, for trying rollback without one.
+// Each message is delivered delay seconds after it was sent, give or take a
+// uniform jitter, so with enough jitter messages overtake each other as they
+// can on UDP. Timing comes from the caller's clock and the jitter from a seeded
+// Rng, so a run can be repeated exactly.
+class LoopbackLink
+{
+public:
+    LoopbackLink(double delay, double jitter, uint64_t seed);
+
+    void Send(double now, const LinkMessage &message);
+
+    // next message due by now, in order of delivery time; false when none is
+    bool Receive(double now, LinkMessage &message);
+
+    size_t InFlight() const { return queue.size(); }
+
+private:
+    struct Pending
+    {
+        double      deliverAt;
+        LinkMessage message;
+    };
+
+    double               delay;
+    double               jitter;
+    Rng                  rng;
+    std::vector<Pending> queue;
+};
@@ -0,0 +1,57 @@
+#include <iterator>
+
+#include "core/snakeBody.h"
+
+SnakeBody::SnakeBody(int gridWidth, int gridHeight)
+    : ring(INITIAL_CAPACITY)
+    , occupancy(gridWidth, gridHeight)
+{
+}
+
+void SnakeBody::Reset(std::initializer_list<Vec2i> segments)
+{
+    Clear();
+
+    // push tail first so the first segment ends up as the head
+    for (auto it = std::rbegin(segments); it != std::rend(segments); ++it) {
+        PushHead(*it);
+    }
+}
+
+void SnakeBody::Clear()
+{
+    // only the snake's own cells are set, so this is O(length), not O(cells)
+    for (size_t i = 0; i < count; i++) {
+        occupancy.Clear((*this)[i]);
+    }
+    head  = 0;
+    count = 0;
+}
+
+void SnakeBody::PushHead(const Vec2i &cell)
+{
+    if (count == ring.size()) {
+        Grow();
+    }
+
+    head       = (head - 1) & (ring.size() - 1);
+    ring[head] = cell;
+    count++;
+    occupancy.Set(cell);
+}
+
+void SnakeBody::PopTail()
+{
+    occupancy.Clear(Tail());
+    count--;
+}
+
+void SnakeBody::Grow()
+{
+    std::vector<Vec2i> grown(ring.size() * 2);
+    for (size_t i = 0; i < count; i++) {
+        grown[i] = (*this)[i];
+    }
+    ring.swap(grown);
+    head = 0;
+}
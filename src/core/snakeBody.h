@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "core/occupancyGrid.h"
+#include "core/vec.h"
+
+// Snake segments in a ring buffer, head first, mirrored by a bit-packed
+// occupancy grid. Moving the head, dropping the tail, testing a cell and picking
+// a free cell do not depend on the length of the snake. The ring grows with the
+// snake, so memory follows the snake's length rather than the board's area.
+class SnakeBody
+{
+public:
+    SnakeBody(int gridWidth, int gridHeight);
+
+    // replaces the body, segments are given head first
+    void Reset(std::initializer_list<Vec2i> segments);
+    void Clear();
+
+    void PushHead(const Vec2i &cell);
+    void PopTail();
+
+    bool Occupied(const Vec2i &cell) const { return occupancy.Test(cell); }
+
+    // segment i counted from the head
+    const Vec2i &operator[](size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    const Vec2i &Head() const { return ring[head]; }
+
+    const Vec2i &Tail() const { return (*this)[count - 1]; }
+
+    size_t Size() const { return count; }
+
+    const OccupancyGrid &Occupancy() const { return occupancy; }
+
+    bool Empty() const { return count == 0; }
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 16;
+
+    // doubles the ring, keeping the segments in order
+    void Grow();
+
+    std::vector<Vec2i> ring;  // power-of-two size
+    size_t             head  = 0;
+    size_t             count = 0;
+    OccupancyGrid      occupancy;
+};
@@ -0,0 +1,35 @@
+#include "core/snapshotSnake.h"
+
+void SnapshotSnake::Assign(const SnakeBody &body)
+{
+    size_t capacity = ring.size();
+    while (capacity <= body.Size()) {
+        capacity *= 2;
+    }
+    if (capacity != ring.size()) {
+        ring.assign(capacity, Vec2i());
+    }
+
+    head  = 0;
+    count = body.Size();
+    for (size_t i = 0; i < count; i++) {
+        ring[i] = body[i];
+    }
+}
+
+void SnapshotSnake::PushHead(const Vec2i &cell)
+{
+    // doubles the ring, keeping the segments in order
+    if (count == ring.size()) {
+        std::vector<Vec2i> grown(ring.size() * 2);
+        for (size_t i = 0; i < count; i++) {
+            grown[i] = (*this)[i];
+        }
+        ring.swap(grown);
+        head = 0;
+    }
+
+    head       = (head - 1) & (ring.size() - 1);
+    ring[head] = cell;
+    count++;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/snakeBody.h"
+#include "core/vec.h"
+
+// The snake as a snapshot holds it, head first. A power-of-two ring like
+// SnakeBody's without the occupancy grid, so a snapshot slot catches up with a
+// tick by changing its ends rather than copying every segment.
+class SnapshotSnake
+{
+public:
+    SnapshotSnake()
+        : ring(INITIAL_CAPACITY)
+    {
+    }
+
+    // copies every segment, for when the moves since this was filled are not known
+    void Assign(const SnakeBody &body);
+
+    void PushHead(const Vec2i &cell);
+    void PopTail() { count--; }
+
+    // segment i counted from the head
+    const Vec2i &operator[](size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    size_t Size() const { return count; }
+    bool   Empty() const { return count == 0; }
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 16;
+
+    std::vector<Vec2i> ring;
+    size_t             head  = 0;
+    size_t             count = 0;
+};
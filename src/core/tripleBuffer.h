@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest value from one writer thread to one reader thread without
+// either side ever waiting. The writer fills its back slot and swaps it with the
+// shared middle slot, the reader swaps the middle slot for its front slot when a
+// new value has been published. A slow reader only skips values and a slow writer
+// only makes the reader see the same value again. Slots are reused, so a T holding
+// vectors keeps their capacity and publishing stops allocating once it has grown.
+template<typename T>
+class TripleBuffer
+{
+public:
+    // writer side: fill Back(), then Publish() hands it to the reader
+    T &Back() { return slots[back]; }
+
+    void Publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+    // reader side: moves to the newest published value, false when nothing new has
+    // arrived and Front() is unchanged
+    bool Acquire()
+    {
+        // only Acquire clears FRESH, so it cannot go away between the load and the exchange
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T &Front() const { return slots[front]; }
+
+private:
+    static constexpr uint32_t INDEX = 3;
+    static constexpr uint32_t FRESH = 4;
+
+    T slots[3];
+
+    // each index on its own cache line, back and front are private to their thread
+    alignas(64) std::atomic<uint32_t> middle{1};
+    alignas(64) uint32_t              back  = 0;
+    alignas(64) uint32_t              front = 2;
+};
@@ -0,0 +1,186 @@
+#include "core/bits.h"
+#include "core/versus.h"
+
+const size_t OCCUPIED_WORDS = VERSUS_MAX_CELLS / 64;
+
+static bool Occupied(const VersusState &state, uint32_t cell)
+{
+    return (state.occupied[cell >> 6] >> (cell & 63)) & 1;
+}
+
+static Vec2i HeadCell(const VersusState &state, const VersusSnake &snake)
+{
+    uint32_t head = snake.segments[snake.head];
+    return Vec2i(static_cast<int>(head % state.width), static_cast<int>(head / state.width));
+}
+
+static void PushHead(VersusState &state, VersusSnake &snake, uint32_t cell)
+{
+    snake.head                 = static_cast<uint16_t>((snake.head + VERSUS_MAX_CELLS - 1) % VERSUS_MAX_CELLS);
+    snake.segments[snake.head] = static_cast<uint16_t>(cell);
+    snake.count++;
+    state.occupied[cell >> 6] |= uint64_t(1) << (cell & 63);
+}
+
+static void PopTail(VersusState &state, VersusSnake &snake)
+{
+    uint32_t cell = snake.segments[(snake.head + snake.count - 1) % VERSUS_MAX_CELLS];
+    state.occupied[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+    snake.count--;
+}
+
+// the n-th free cell in row-major order, like OccupancyGrid::NthFree; false when the board is full
+static bool SpawnFruit(VersusState &state)
+{
+    uint32_t cells = static_cast<uint32_t>(state.width * state.height);
+    uint32_t taken = 0;
+    for (size_t i = 0; i < OCCUPIED_WORDS; i++) {
+        taken += Popcount64(state.occupied[i]);
+    }
+    if (taken == cells) {
+        return false;
+    }
+
+    uint32_t n = state.rng.NextBelow(cells - taken);
+    for (uint32_t word = 0;; word++) {
+        // free cells of this word, none past the end of the board
+        uint32_t inWord = cells - word * 64 < 64 ? cells - word * 64 : 64;
+        uint64_t valid  = inWord == 64 ? ~uint64_t(0) : (uint64_t(1) << inWord) - 1;
+        uint64_t free   = ~state.occupied[word] & valid;
+        uint32_t count  = static_cast<uint32_t>(Popcount64(free));
+        if (n < count) {
+            state.fruit = static_cast<uint16_t>(word * 64 + SelectBit64(free, static_cast<int>(n)));
+            return true;
+        }
+        n -= count;
+    }
+}
+
+// the snakes facing each other from a third of the way in from the top and bottom
+static void StartRound(VersusState &state)
+{
+    for (size_t i = 0; i < OCCUPIED_WORDS; i++) {
+        state.occupied[i] = 0;
+    }
+
+    int rows[VERSUS_PLAYERS] = {state.height / 3, state.height - 1 - state.height / 3};
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        VersusSnake &snake = state.snakes[player];
+        snake.head         = 0;
+        snake.count        = 0;
+        snake.score        = 0;
+        snake.direction    = player == 0 ? Direction::Right : Direction::Left;
+
+        // pushed tail first, the head ends up 5 cells in from the snake's own side
+        for (int i = 3; i <= 5; i++) {
+            int x = player == 0 ? i : state.width - 1 - i;
+            PushHead(state, snake, static_cast<uint32_t>(rows[player] * state.width + x));
+        }
+    }
+
+    state.round++;
+    state.result = VersusResult::Ongoing;
+    SpawnFruit(state);
+}
+
+void ResetVersus(VersusState &state, int width, int height, uint64_t seed)
+{
+    state.width  = width;
+    state.height = height;
+    state.tick   = 0;
+    state.round  = 0;
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        state.wins[player] = 0;
+    }
+    state.rng.Seed(seed);
+    StartRound(state);
+}
+
+void StepVersus(VersusState &state, const Direction inputs[VERSUS_PLAYERS])
+{
+    state.tick++;
+    if (state.result != VersusResult::Ongoing) {
+        StartRound(state);
+        return;
+    }
+
+    uint32_t next[VERSUS_PLAYERS];
+    bool     dead[VERSUS_PLAYERS];
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        VersusSnake &snake = state.snakes[player];
+        if (inputs[player] != Direction::None && inputs[player] != Reverse(snake.direction)) {
+            snake.direction = inputs[player];
+        }
+
+        Vec2i cell   = Neighbour(HeadCell(state, snake), snake.direction);
+        bool  inside = cell.x >= 0 && cell.x < state.width && cell.y >= 0 && cell.y < state.height;
+        next[player] = inside ? static_cast<uint32_t>(cell.y * state.width + cell.x) : 0;
+        dead[player] = !inside || Occupied(state, next[player]);
+    }
+    if (!dead[0] && !dead[1] && next[0] == next[1]) {
+        dead[0] = true;
+        dead[1] = true;
+    }
+
+    // the round ends on the board as it was before the crash
+    if (dead[0] || dead[1]) {
+        if (dead[0] && dead[1]) {
+            state.result = VersusResult::Draw;
+        } else {
+            state.result = dead[1] ? VersusResult::FirstWon : VersusResult::SecondWon;
+            state.wins[dead[1] ? 0 : 1]++;
+        }
+        return;
+    }
+
+    bool eaten = false;
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        VersusSnake &snake = state.snakes[player];
+        PushHead(state, snake, next[player]);
+        if (next[player] == state.fruit) {
+            snake.score += 10;
+            eaten = true;
+        } else {
+            PopTail(state, snake);
+        }
+    }
+
+    // a full board ends the round without a winner
+    if (eaten && !SpawnFruit(state)) {
+        state.result = VersusResult::Draw;
+    }
+}
+
+bool VersusBlocked(const VersusState &state, int player, Direction direction)
+{
+    Vec2i cell = Neighbour(HeadCell(state, state.snakes[player]), direction);
+    if (cell.x < 0 || cell.x >= state.width || cell.y < 0 || cell.y >= state.height) {
+        return true;
+    }
+    return Occupied(state, static_cast<uint32_t>(cell.y * state.width + cell.x));
+}
+
+uint64_t VersusChecksum(const VersusState &state)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto     mix  = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+
+    mix(state.tick);
+    mix(state.round);
+    mix(static_cast<uint64_t>(state.result));
+    mix(state.fruit);
+    mix(state.rng.state);
+    for (int player = 0; player < VERSUS_PLAYERS; player++) {
+        const VersusSnake &snake = state.snakes[player];
+        mix(state.wins[player]);
+        mix(static_cast<uint64_t>(snake.score));
+        mix(static_cast<uint64_t>(snake.direction));
+        for (uint32_t i = 0; i < snake.count; i++) {
+            mix(snake.segments[(snake.head + i) % VERSUS_MAX_CELLS]);
+        }
+    }
+    return hash;
+}
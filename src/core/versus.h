@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/gameState.h"
+#include "core/rng.h"
+
+// boards up to 32x32, which keeps a whole VersusState in a few KB
+const int    VERSUS_MAX_SIDE  = 32;
+const size_t VERSUS_MAX_CELLS = VERSUS_MAX_SIDE * VERSUS_MAX_SIDE;
+const int    VERSUS_PLAYERS   = 2;
+
+enum class VersusResult : uint8_t
+{
+    Ongoing,
+    FirstWon,
+    SecondWon,
+    Draw
+};
+
+// Segments as cell indices in a fixed ring, head first
+struct VersusSnake
+{
+    uint16_t  segments[VERSUS_MAX_CELLS];
+    uint16_t  head;
+    uint16_t  count;
+    Direction direction;
+    int32_t   score;
+};
+
+// Complete state of a two-player round, plain data with no pointers or heap
+// storage, so saving and restoring it for rollback is one memcpy of a few KB.
+// Like GameState, everything that affects the outcome, the RNG included, is in
+// here, and the same inputs from the same state give the same result anywhere.
+struct VersusState
+{
+    int32_t      width;
+    int32_t      height;
+    uint64_t     tick;
+    uint32_t     round;  // rounds started, a new one follows a finished one on the next tick
+    uint32_t     wins[VERSUS_PLAYERS];
+    VersusResult result;
+    uint16_t     fruit;
+    Rng          rng;
+    uint64_t     occupied[VERSUS_MAX_CELLS / 64];  // both bodies, bit per cell in row-major order
+    VersusSnake  snakes[VERSUS_PLAYERS];
+};
+
+// A fresh match: zero wins and the first round placed from seed. Side lengths
+// between MIN_GRID_SIZE and VERSUS_MAX_SIDE.
+void ResetVersus(VersusState &state, int width, int height, uint64_t seed);
+
+// One tick with one input per player, None keeps the heading. Both snakes move
+// at once: a head dies on a wall or any body, tails included as in Step(), and
+// heads that meet on a cell both die. One snake left alive wins the round, none
+// is a draw. The tick after a round ends starts the next one.
+void StepVersus(VersusState &state, const Direction inputs[VERSUS_PLAYERS]);
+
+// true when that player's head moving that way would hit a wall or a body; heads
+// meeting on a free cell are not foreseen
+bool VersusBlocked(const VersusState &state, int player, Direction direction);
+
+// hash of the state's meaningful fields, equal for equal games whatever is in
+// the unused ends of the segment rings
+uint64_t VersusChecksum(const VersusState &state);
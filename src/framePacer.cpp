@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "framePacer.h"
+
+// bounds for the adaptive spin margin
+const std::chrono::microseconds MIN_SPIN_MARGIN(200);
+const std::chrono::microseconds MAX_SPIN_MARGIN(4000);
+
+void FramePacer::Configure(PacingMode mode, double targetFps)
+{
+    this->mode      = mode;
+    this->targetFps = targetFps > 0.0 ? targetFps : 60.0;
+    period          = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / this->targetFps));
+    started         = false;
+    m2              = 0.0;
+    stats           = FramePacingStats();
+}
+
+void FramePacer::EndFrame()
+{
+    Clock::time_point now = Clock::now();
+
+    if (mode == PacingMode::TargetFps) {
+        if (!started) {
+            nextDeadline = now + period;
+        }
+        WaitUntil(nextDeadline);
+        now = Clock::now();
+
+        // keep a fixed cadence, a late frame shortens the next wait, but after a
+        // stall longer than a frame start over instead of rushing to catch up
+        nextDeadline += period;
+        if (now - nextDeadline > period) {
+            nextDeadline = now + period;
+        }
+    }
+
+    if (started) {
+        Record(std::chrono::duration<double>(now - lastFrame).count());
+    }
+    lastFrame = now;
+    started   = true;
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline)
+{
+    Clock::time_point now = Clock::now();
+
+    // sleep through most of the wait, leaving the margin for oversleep
+    Clock::duration sleepFor = deadline - now - spinMargin;
+    if (sleepFor > Clock::duration::zero()) {
+        std::this_thread::sleep_for(sleepFor);
+        Clock::time_point woke = Clock::now();
+
+        // track twice the observed oversleep, smoothed, as the next margin
+        Clock::duration oversleep = (woke - now) - sleepFor;
+        Clock::duration margin    = (spinMargin * 7 + oversleep * 2) / 8;
+        spinMargin                = std::clamp<Clock::duration>(margin, MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+
+        stats.sleepTime += std::chrono::duration<double>(woke - now).count();
+        now = woke;
+    }
+
+    // spin the rest, yielding so a sibling thread can still run
+    Clock::time_point spinStart = now;
+    while (now < deadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+    stats.spinTime += std::chrono::duration<double>(now - spinStart).count();
+}
+
+void FramePacer::Record(double interval)
+{
+    // Welford's running mean and variance
+    stats.frames++;
+    double delta = interval - stats.meanInterval;
+    stats.meanInterval += delta / stats.frames;
+    m2 += delta * (interval - stats.meanInterval);
+    stats.jitter = std::sqrt(m2 / stats.frames);
+
+    if (stats.frames == 1) {
+        stats.minInterval = interval;
+        stats.maxInterval = interval;
+    } else {
+        stats.minInterval = std::min(stats.minInterval, interval);
+        stats.maxInterval = std::max(stats.maxInterval, interval);
+    }
+}
+
+const char *FramePacer::ModeName(PacingMode mode)
+{
+    switch (mode) {
+        case PacingMode::Vsync:
+            return "vsync";
+        case PacingMode::TargetFps:
+            return "fps";
+        case PacingMode::Uncapped:
+            return "uncapped";
+    }
+    return "unknown";
+}
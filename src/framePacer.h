@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+
+enum class PacingMode
+{
+    Vsync,      // swap interval 1, the driver blocks in SwapBuffers
+    TargetFps,  // swap interval 0, we wait out the rest of each frame ourselves
+    Uncapped    // swap interval 0, no waiting, for benchmarks
+};
+
+// Achieved frame-to-frame intervals and where the waiting time went
+struct FramePacingStats
+{
+    long   frames       = 0;
+    double meanInterval = 0.0;  // seconds
+    double jitter       = 0.0;  // standard deviation of the interval, seconds
+    double minInterval  = 0.0;
+    double maxInterval  = 0.0;
+    double sleepTime    = 0.0;  // total seconds the thread slept
+    double spinTime     = 0.0;  // total seconds spent spinning to the deadline
+};
+
+// Paces the main loop after each present. In TargetFps mode it sleeps until just
+// before the frame deadline and spins the last stretch, so the thread stays idle
+// for most of the frame without inheriting the OS sleep granularity. The spin
+// margin follows the measured oversleep, so it shrinks on systems with precise
+// timers and grows where sleeps overshoot.
+class FramePacer
+{
+public:
+    void Configure(PacingMode mode, double targetFps = 60.0);
+
+    PacingMode Mode() const { return mode; }
+
+    double TargetFps() const { return targetFps; }
+
+    // call once per frame after the swap, blocks in TargetFps mode
+    void EndFrame();
+
+    const FramePacingStats &Stats() const { return stats; }
+
+    static const char *ModeName(PacingMode mode);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void WaitUntil(Clock::time_point deadline);
+    void Record(double interval);
+
+    PacingMode        mode       = PacingMode::Vsync;
+    double            targetFps  = 60.0;
+    Clock::duration   period     = Clock::duration::zero();
+    Clock::duration   spinMargin = std::chrono::milliseconds(2);
+    Clock::time_point nextDeadline;
+    Clock::time_point lastFrame;
+    bool              started = false;
+    double            m2      = 0.0;  // running sum of squared deviations, for jitter
+    FramePacingStats  stats;
+};
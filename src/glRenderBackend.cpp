@@ -0,0 +1,111 @@
+#include "glRenderBackend.h"
+#include "profiler.h"
+
+static void ExecuteGl(const RenderCommandBuffer &commands, void *context)
+{
+    static_cast<GlRenderBackend *>(context)->Execute(commands);
+}
+
+void GlRenderBackend::Init(GLuint quadVBO, ShaderProgram *program, StreamBuffer *streamBuffer, TextRenderer *text)
+{
+    quadProgram  = program;
+    stream       = streamBuffer;
+    textRenderer = text;
+
+    // every batch shares the unit quad, the dynamic one streams its instances
+    quads.Init(quadVBO, stream);
+    for (QuadBatch &layer : retained) {
+        layer.Init(quadVBO);
+    }
+}
+
+void GlRenderBackend::Destroy()
+{
+    quads.Destroy();
+    for (QuadBatch &layer : retained) {
+        layer.Destroy();
+    }
+}
+
+RenderBackend GlRenderBackend::Backend()
+{
+    return {ExecuteGl, this};
+}
+
+// uView only changes once a frame, so it is uploaded with the first quads
+void GlRenderBackend::UseQuadProgram(const RenderCommandBuffer &commands)
+{
+    if (activeProgram != RenderProgram::Quads) {
+        quadProgram->Use();
+        activeProgram = RenderProgram::Quads;
+    }
+    if (!viewUploaded) {
+        const float *view = commands.View();
+        glUniform4f(quadProgram->Uniform("uView"), view[0], view[1], view[2], view[3]);
+        renderStats.uniformUploads++;
+        viewUploaded = true;
+    }
+}
+
+void GlRenderBackend::Execute(const RenderCommandBuffer &commands)
+{
+    PROFILE_SCOPE("ExecuteCommands");
+
+    const std::vector<RenderCommand> &list      = commands.Commands();
+    const std::vector<QuadInstance>  &instances = commands.Quads();
+
+    // claim this frame's region of the stream buffer
+    stream->BeginFrame();
+    activeProgram = RenderProgram::None;
+    viewUploaded  = false;
+
+    for (const RenderBatch &batch : commands.Batches()) {
+        PROFILE_GPU_SCOPE(RenderLayerName(batch.layer));
+
+        switch (batch.type) {
+            case RenderCommandType::Clear: {
+                for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                    const Vec3 &color = list[i].color;
+                    glClearColor(color.r, color.g, color.b, 1.0f);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                }
+            } break;
+            case RenderCommandType::Quads: {
+                // everything in the batch goes out in one instanced draw
+                UseQuadProgram(commands);
+                std::vector<QuadInstance> &batched = quads.Instances();
+                for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                    const RenderCommand &command = list[i];
+                    batched.insert(batched.end(),
+                                   instances.begin() + command.first,
+                                   instances.begin() + command.first + command.count);
+                }
+                quads.Flush();
+            } break;
+            case RenderCommandType::RetainedQuads: {
+                UseQuadProgram(commands);
+                for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                    const RenderCommand &command = list[i];
+                    QuadBatch           &layer   = retained[static_cast<int>(command.layer)];
+                    if (command.rebuild) {
+                        layer.Instances().assign(instances.begin() + command.first,
+                                                 instances.begin() + command.first + command.count);
+                        layer.Upload(GL_STATIC_DRAW);
+                    }
+                    layer.Draw();
+                }
+            } break;
+            case RenderCommandType::Text: {
+                for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                    const RenderCommand &command = list[i];
+                    textRenderer->Draw(commands.Text(command), command.x, command.y, command.scale, command.color);
+                }
+                textRenderer->Flush();
+                activeProgram = RenderProgram::Text;
+            } break;
+        }
+    }
+
+    glBindVertexArray(0);
+    stream->EndFrame();
+}
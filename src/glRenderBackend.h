@@ -0,0 +1,37 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "quadBatch.h"
+#include "renderCommands.h"
+#include "shader.h"
+#include "streamBuffer.h"
+#include "textRenderer.h"
+
+// Draws command buffers with GL. The dynamic quads of a batch are streamed
+// through one QuadBatch and drawn with one instanced call, every layer has a
+// retained QuadBatch for RetainedQuads commands, and text goes to the
+// TextRenderer, which keeps its per-string meshes between frames.
+class GlRenderBackend
+{
+public:
+    // the program, stream buffer and text renderer stay owned by the caller
+    void Init(GLuint quadVBO, ShaderProgram *quadProgram, StreamBuffer *stream, TextRenderer *textRenderer);
+    void Destroy();
+
+    void Execute(const RenderCommandBuffer &commands);
+
+    // a RenderBackend that draws with this
+    RenderBackend Backend();
+
+private:
+    void UseQuadProgram(const RenderCommandBuffer &commands);
+
+    ShaderProgram *quadProgram   = nullptr;
+    StreamBuffer  *stream        = nullptr;
+    TextRenderer  *textRenderer  = nullptr;
+    RenderProgram  activeProgram = RenderProgram::None;
+    bool           viewUploaded  = false;
+    QuadBatch      quads;
+    QuadBatch      retained[static_cast<int>(RenderLayer::Count)];
+};
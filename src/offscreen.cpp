@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "offscreen.h"
+
+bool OffscreenTarget::Init(int width, int height)
+{
+    targetWidth  = width;
+    targetHeight = height;
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+void OffscreenTarget::Destroy()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    fbo         = 0;
+    colorBuffer = 0;
+}
+
+void OffscreenTarget::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, targetWidth, targetHeight);
+}
+
+void OffscreenTarget::Read(Image &image) const
+{
+    image.width  = targetWidth;
+    image.height = targetHeight;
+    image.pixels.resize(static_cast<size_t>(targetWidth) * targetHeight * 4);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+
+    // GL rows start at the bottom
+    size_t               rowBytes = static_cast<size_t>(targetWidth) * 4;
+    std::vector<uint8_t> row(rowBytes);
+    for (int y = 0; y < targetHeight / 2; y++) {
+        uint8_t *top    = &image.pixels[y * rowBytes];
+        uint8_t *bottom = &image.pixels[(targetHeight - 1 - y) * rowBytes];
+        std::copy(top, top + rowBytes, row.begin());
+        std::copy(bottom, bottom + rowBytes, top);
+        std::copy(row.begin(), row.end(), bottom);
+    }
+}
+
+bool WritePng(const std::string &path, const Image &image)
+{
+    return stbi_write_png(path.c_str(), image.width, image.height, 4, image.pixels.data(), image.width * 4) != 0;
+}
+
+// canonical Huffman code for Inflate, codes of up to 15 bits
+struct Huffman
+{
+    uint16_t counts[16];    // codes of each length
+    uint16_t symbols[320];  // ordered by code
+};
+
+// deflate streams are read least significant bit first
+struct BitReader
+{
+    const uint8_t *data;
+    size_t         size;
+    size_t         pos     = 0;
+    uint32_t       bits    = 0;
+    int            count   = 0;
+    bool           overrun = false;
+
+    uint32_t Read(int n)
+    {
+        while (count < n) {
+            if (pos >= size) {
+                overrun = true;
+                return 0;
+            }
+            bits |= static_cast<uint32_t>(data[pos++]) << count;
+            count += 8;
+        }
+        uint32_t value = bits & ((1u << n) - 1);
+        bits >>= n;
+        count -= n;
+        return value;
+    }
+};
+
+static void BuildHuffman(Huffman &code, const uint8_t *lengths, int symbolCount)
+{
+    std::fill(std::begin(code.counts), std::end(code.counts), 0);
+    for (int i = 0; i < symbolCount; i++) {
+        code.counts[lengths[i]]++;
+    }
+    code.counts[0] = 0;
+
+    uint16_t offsets[16] = {};
+    for (int length = 1; length < 15; length++) {
+        offsets[length + 1] = offsets[length] + code.counts[length];
+    }
+    for (int i = 0; i < symbolCount; i++) {
+        if (lengths[i] != 0) {
+            code.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+    }
+}
+
+// one bit at a time, which is plenty for a few golden images
+static int Decode(BitReader &in, const Huffman &code)
+{
+    int value = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= 15; length++) {
+        value |= static_cast<int>(in.Read(1));
+        int count = code.counts[length];
+        if (value - first < count) {
+            return code.symbols[index + value - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        value <<= 1;
+    }
+    return -1;
+}
+
+// match lengths and distances are a base for the symbol plus extra bits, the
+// bases doubling their step every four length and every two distance symbols
+static size_t ReadLength(BitReader &in, int symbol)
+{
+    if (symbol < 8 || symbol == 28) {
+        return symbol == 28 ? 258 : 3 + symbol;
+    }
+    int extra = (symbol - 4) / 4;
+    return ((4 + (symbol & 3)) << extra) + 3 + in.Read(extra);
+}
+
+static size_t ReadDistance(BitReader &in, int symbol)
+{
+    if (symbol < 4) {
+        return 1 + symbol;
+    }
+    int extra = (symbol - 2) / 2;
+    return ((2 + (symbol & 1)) << extra) + 1 + in.Read(extra);
+}
+
+// a raw deflate stream: stored, fixed and dynamic Huffman blocks
+static bool Inflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+{
+    static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    BitReader in{data, size};
+    bool      last = false;
+    while (!last) {
+        last          = in.Read(1) != 0;
+        uint32_t type = in.Read(2);
+
+        if (type == 0) {
+            // stored: the rest of the byte is dropped, then a length, its complement and the bytes
+            in.bits  = 0;
+            in.count = 0;
+            if (in.pos + 4 > size) {
+                return false;
+            }
+            size_t length = data[in.pos] | (data[in.pos + 1] << 8);
+            in.pos += 4;
+            if (in.pos + length > size) {
+                return false;
+            }
+            out.insert(out.end(), data + in.pos, data + in.pos + length);
+            in.pos += length;
+            continue;
+        }
+
+        Huffman literals;
+        Huffman distances;
+        uint8_t lengths[320];
+        if (type == 1) {
+            std::fill(lengths, lengths + 144, 8);
+            std::fill(lengths + 144, lengths + 256, 9);
+            std::fill(lengths + 256, lengths + 280, 7);
+            std::fill(lengths + 280, lengths + 288, 8);
+            std::fill(lengths + 288, lengths + 318, 5);
+            BuildHuffman(literals, lengths, 288);
+            BuildHuffman(distances, lengths + 288, 30);
+        } else if (type == 2) {
+            int     literalCount  = static_cast<int>(in.Read(5)) + 257;
+            int     distanceCount = static_cast<int>(in.Read(5)) + 1;
+            int     lengthCount   = static_cast<int>(in.Read(4)) + 4;
+            uint8_t codeLengths[19] = {};
+            for (int i = 0; i < lengthCount; i++) {
+                codeLengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(in.Read(3));
+            }
+            Huffman lengthCode;
+            BuildHuffman(lengthCode, codeLengths, 19);
+
+            // the literal and distance code lengths, with runs of repeats and zeros
+            int total = literalCount + distanceCount;
+            for (int n = 0; n < total;) {
+                int symbol = Decode(in, lengthCode);
+                if (symbol < 0 || (symbol == 16 && n == 0)) {
+                    return false;
+                }
+                if (symbol < 16) {
+                    lengths[n++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+                uint8_t value  = symbol == 16 ? lengths[n - 1] : 0;
+                int     repeat = symbol == 16 ? 3 + in.Read(2) : symbol == 17 ? 3 + in.Read(3) : 11 + in.Read(7);
+                if (n + repeat > total) {
+                    return false;
+                }
+                std::fill(lengths + n, lengths + n + repeat, value);
+                n += repeat;
+            }
+            BuildHuffman(literals, lengths, literalCount);
+            BuildHuffman(distances, lengths + literalCount, distanceCount);
+        } else {
+            return false;
+        }
+
+        for (;;) {
+            int symbol = Decode(in, literals);
+            if (symbol < 0 || in.overrun) {
+                return false;
+            }
+            if (symbol < 256) {
+                out.push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+            if (symbol == 256) {
+                break;
+            }
+
+            // the length's extra bits come before the distance
+            symbol -= 257;
+            if (symbol >= 29) {
+                return false;
+            }
+            size_t length         = ReadLength(in, symbol);
+            int    distanceSymbol = Decode(in, distances);
+            if (distanceSymbol < 0 || distanceSymbol >= 30) {
+                return false;
+            }
+            size_t distance = ReadDistance(in, distanceSymbol);
+            if (distance > out.size()) {
+                return false;
+            }
+            // the copy may overlap what it is writing
+            size_t from = out.size() - distance;
+            for (size_t i = 0; i < length; i++) {
+                uint8_t byte = out[from + i];
+                out.push_back(byte);
+            }
+        }
+    }
+    return !in.overrun;
+}
+
+static uint32_t BigEndian32(const uint8_t *bytes)
+{
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+static uint8_t Paeth(int left, int up, int upLeft)
+{
+    int estimate = left + up - upLeft;
+    int toLeft   = std::abs(estimate - left);
+    int toUp     = std::abs(estimate - up);
+    int toCorner = std::abs(estimate - upLeft);
+    if (toLeft <= toUp && toLeft <= toCorner) {
+        return static_cast<uint8_t>(left);
+    }
+    return static_cast<uint8_t>(toUp <= toCorner ? up : upLeft);
+}
+
+bool ReadPng(const std::string &path, Image &image)
+{
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long fileSize = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    std::vector<uint8_t> bytes(fileSize > 0 ? static_cast<size_t>(fileSize) : 0);
+    bool ok = fileSize > 0 && std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    std::fclose(file);
+
+    static const uint8_t SIGNATURE[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    if (!ok || bytes.size() < 8 || !std::equal(SIGNATURE, SIGNATURE + 8, bytes.begin())) {
+        return false;
+    }
+
+    // chunks are length, type, data and CRC; the image data may be split over several IDATs
+    std::vector<uint8_t> compressed;
+    bool                 header = false;
+    for (size_t pos = 8; pos + 12 <= bytes.size();) {
+        uint32_t       length = BigEndian32(&bytes[pos]);
+        const uint8_t *type   = &bytes[pos + 4];
+        const uint8_t *data   = &bytes[pos + 8];
+        if (length > bytes.size() - pos - 12) {
+            return false;
+        }
+
+        if (!std::memcmp(type, "IHDR", 4) && length == 13) {
+            // only what WritePng produces: 8-bit RGBA, not interlaced
+            image.width  = static_cast<int>(BigEndian32(data));
+            image.height = static_cast<int>(BigEndian32(data + 4));
+            header       = data[8] == 8 && data[9] == 6 && data[12] == 0 && image.width > 0 && image.height > 0;
+            if (!header) {
+                return false;
+            }
+        } else if (!std::memcmp(type, "IDAT", 4)) {
+            compressed.insert(compressed.end(), data, data + length);
+        } else if (!std::memcmp(type, "IEND", 4)) {
+            break;
+        }
+        pos += 12 + length;
+    }
+
+    // a zlib header in front of the deflate stream
+    size_t               rowBytes = static_cast<size_t>(image.width) * 4;
+    std::vector<uint8_t> filtered;
+    filtered.reserve((rowBytes + 1) * image.height);
+    if (!header || compressed.size() < 2 || (compressed[0] & 0x0f) != 8
+        || !Inflate(compressed.data() + 2, compressed.size() - 2, filtered)
+        || filtered.size() < (rowBytes + 1) * image.height) {
+        return false;
+    }
+
+    // every row starts with its filter, which predicts from the pixel to the left and the row above
+    image.pixels.resize(rowBytes * image.height);
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t *src    = &filtered[y * (rowBytes + 1)];
+        uint8_t       *dst    = &image.pixels[y * rowBytes];
+        const uint8_t *above  = y > 0 ? dst - rowBytes : nullptr;
+        uint8_t        filter = *src++;
+        for (size_t x = 0; x < rowBytes; x++) {
+            int left    = x >= 4 ? dst[x - 4] : 0;
+            int up      = above ? above[x] : 0;
+            int upLeft  = above && x >= 4 ? above[x - 4] : 0;
+            int predict = 0;
+            switch (filter) {
+                case 0:
+                    break;
+                case 1:
+                    predict = left;
+                    break;
+                case 2:
+                    predict = up;
+                    break;
+                case 3:
+                    predict = (left + up) / 2;
+                    break;
+                case 4:
+                    predict = Paeth(left, up, upLeft);
+                    break;
+                default:
+                    return false;
+            }
+            dst[x] = static_cast<uint8_t>(src[x] + predict);
+        }
+    }
+    return true;
+}
+
+ImageDiff CompareImages(const Image &a, const Image &b, int tolerance, Image *diffImage)
+{
+    ImageDiff diff;
+    if (a.width != b.width || a.height != b.height) {
+        diff.differingPixels = static_cast<size_t>(std::max(a.width * a.height, b.width * b.height));
+        diff.maxDelta        = 255;
+        return diff;
+    }
+
+    if (diffImage) {
+        *diffImage = a;
+    }
+
+    size_t pixelCount = static_cast<size_t>(a.width) * a.height;
+    for (size_t i = 0; i < pixelCount; i++) {
+        int delta = 0;
+        for (int c = 0; c < 4; c++) {
+            delta = std::max(delta, std::abs(a.pixels[i * 4 + c] - b.pixels[i * 4 + c]));
+        }
+        diff.maxDelta = std::max(diff.maxDelta, delta);
+
+        if (delta > tolerance) {
+            diff.differingPixels++;
+            if (diffImage) {
+                uint8_t *pixel = &diffImage->pixels[i * 4];
+                pixel[0]       = 255;
+                pixel[1]       = 0;
+                pixel[2]       = 0;
+                pixel[3]       = 255;
+            }
+        }
+    }
+    return diff;
+}
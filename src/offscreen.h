@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// RGBA8 image, rows top to bottom
+struct Image
+{
+    int                  width  = 0;
+    int                  height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Framebuffer object with a single RGBA8 color renderbuffer. Headless runs draw
+// into this instead of the default framebuffer, which the null platform may not
+// have, and read frames back from it.
+class OffscreenTarget
+{
+public:
+    bool Init(int width, int height);
+    void Destroy();
+
+    void Bind() const;
+
+    // reads the current contents, flipped so row 0 is the top
+    void Read(Image &image) const;
+
+private:
+    GLuint fbo          = 0;
+    GLuint colorBuffer  = 0;
+    int    targetWidth  = 0;
+    int    targetHeight = 0;
+};
+
+// Captures and golden images are PNG, written by stb_image_write. Only the
+// writer is vendored, so ReadPng decodes just what WritePng produces: 8-bit
+// RGBA, not interlaced.
+bool WritePng(const std::string &path, const Image &image);
+bool ReadPng(const std::string &path, Image &image);
+
+struct ImageDiff
+{
+    size_t differingPixels = 0;  // pixels with any channel off by more than the tolerance
+    int    maxDelta        = 0;
+};
+
+// compares two images of the same size, diffImage marks differing pixels in red
+ImageDiff CompareImages(const Image &a, const Image &b, int tolerance, Image *diffImage = nullptr);
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "profiler.h"
+
+Profiler profiler;
+
+// ~1.5 MB, a few thousand frames of scopes
+const size_t PROFILE_RING_CAPACITY = 1 << 16;
+
+// GPU events get their own row in the trace
+const uint32_t GPU_TRACK = 1000;
+
+static uint32_t CurrentThreadIndex()
+{
+    static std::atomic<uint32_t> nextIndex{0};
+    thread_local uint32_t        index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+ProfileRing::ProfileRing(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+}
+
+void ProfileRing::Push(const ProfileEvent &event)
+{
+    uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot    &slot  = slots[index & mask];
+
+    // seqlock style publish: odd while the payload is being written
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void ProfileRing::Snapshot(std::vector<ProfileEvent> &out) const
+{
+    uint64_t end   = writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = end > mask + 1 ? end - (mask + 1) : 0;
+
+    for (uint64_t index = begin; index < end; index++) {
+        const Slot &slot = slots[index & mask];
+
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            continue;  // not published yet, or already reused
+        }
+        ProfileEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;  // overwritten while we copied it
+        }
+        out.push_back(event);
+    }
+}
+
+Profiler::Profiler()
+    : origin(std::chrono::steady_clock::now())
+    , ring(PROFILE_RING_CAPACITY)
+{
+}
+
+uint64_t Profiler::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Profiler::Record(const char *name, uint64_t start, uint64_t end)
+{
+    ProfileEvent event;
+    event.name     = name;
+    event.start    = start;
+    event.duration = end - start;
+    event.thread   = CurrentThreadIndex();
+    event.type     = ProfileEventType::Cpu;
+    ring.Push(event);
+}
+
+void Profiler::Counter(const char *name, uint64_t value)
+{
+    if (!Enabled()) {
+        return;
+    }
+
+    ProfileEvent event;
+    event.name     = name;
+    event.start    = Now();
+    event.duration = value;
+    event.thread   = CurrentThreadIndex();
+    event.type     = ProfileEventType::Counter;
+    ring.Push(event);
+}
+
+void Profiler::NameThread(const char *name)
+{
+    uint32_t index = CurrentThreadIndex();
+    if (index < MAX_THREADS) {
+        threadNames[index].store(name, std::memory_order_relaxed);
+    }
+}
+
+void Profiler::InitGpu()
+{
+    for (GpuFrame &frame : gpuFrames) {
+        glGenQueries(GPU_SCOPES, frame.queries);
+        frame.count = 0;
+    }
+    gpuReady = true;
+}
+
+void Profiler::DestroyGpu()
+{
+    if (!gpuReady) {
+        return;
+    }
+    for (GpuFrame &frame : gpuFrames) {
+        glDeleteQueries(GPU_SCOPES, frame.queries);
+        frame.count = 0;
+    }
+    gpuReady = false;
+}
+
+void Profiler::BeginGpu(const char *name)
+{
+    GpuFrame &frame = gpuFrames[frameIndex % GPU_FRAME_LAG];
+    if (!Enabled() || !gpuReady || gpuScopeActive || frame.count == GPU_SCOPES) {
+        return;
+    }
+
+    frame.names[frame.count]  = name;
+    frame.starts[frame.count] = Now();
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.count]);
+    gpuScopeActive = true;
+}
+
+void Profiler::EndGpu()
+{
+    if (!gpuScopeActive) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuFrames[frameIndex % GPU_FRAME_LAG].count++;
+    gpuScopeActive = false;
+}
+
+void Profiler::ResolveGpuFrame(GpuFrame &frame)
+{
+    if (frame.count == 0) {
+        return;
+    }
+
+    // queries are issued GPU_FRAME_LAG frames back, so they are normally long done;
+    // if the driver is further behind the frame is dropped rather than stalling on it
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+        uint64_t total = 0;
+        for (int i = 0; i < frame.count; i++) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+            total += elapsed;
+
+            ProfileEvent event;
+            event.name     = frame.names[i];
+            event.start    = frame.starts[i];
+            event.duration = elapsed;
+            event.thread   = GPU_TRACK;
+            event.type     = ProfileEventType::Gpu;
+            ring.Push(event);
+        }
+        gpuFrameTime = total / 1e6;
+    }
+    frame.count = 0;
+}
+
+void Profiler::BeginFrame()
+{
+    if (Enabled()) {
+        frameStart = Now();
+    }
+}
+
+void Profiler::EndFrame()
+{
+    if (!Enabled()) {
+        return;
+    }
+
+    uint64_t now = Now();
+    Record("Frame", frameStart, now);
+
+    int slot         = frameCount % FRAME_WINDOW;
+    cpuTimes[slot]   = static_cast<float>((now - frameStart) / 1e6);
+    frameTimes[slot] = static_cast<float>((lastFrameEnd ? now - lastFrameEnd : now - frameStart) / 1e6);
+    lastFrameEnd     = now;
+    frameCount++;
+
+    // the slot the next frame writes into was filled GPU_FRAME_LAG - 1 frames ago
+    frameIndex++;
+    if (gpuReady) {
+        ResolveGpuFrame(gpuFrames[frameIndex % GPU_FRAME_LAG]);
+    }
+}
+
+FrameTimePercentiles Profiler::FramePercentiles()
+{
+    FrameTimePercentiles result;
+
+    int count = std::min(frameCount, FRAME_WINDOW);
+    if (count == 0) {
+        return result;
+    }
+
+    std::copy(frameTimes, frameTimes + count, sorted);
+    std::sort(sorted, sorted + count);
+
+    auto at = [&](double fraction) {
+        return static_cast<double>(sorted[std::min(count - 1, static_cast<int>(fraction * count))]);
+    };
+    result.p50 = at(0.50);
+    result.p95 = at(0.95);
+    result.p99 = at(0.99);
+    result.max = sorted[count - 1];
+    return result;
+}
+
+double Profiler::AverageCpuTime() const
+{
+    int count = std::min(frameCount, FRAME_WINDOW);
+    if (count == 0) {
+        return 0.0;
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < count; i++) {
+        total += cpuTimes[i];
+    }
+    return total / count;
+}
+
+bool Profiler::WriteChromeTrace(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "Failed to open trace file " << path << "\n";
+        return false;
+    }
+
+    std::vector<ProfileEvent> events;
+    ring.Snapshot(events);
+
+    char line[256];
+    file << "{\"traceEvents\":[\n";
+
+    // thread labels
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_TRACK
+         << ",\"args\":{\"name\":\"GPU\"}}";
+    for (int i = 0; i < MAX_THREADS; i++) {
+        if (const char *name = threadNames[i].load(std::memory_order_relaxed)) {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\""
+                 << name << "\"}}";
+        }
+    }
+
+    // timestamps are in microseconds
+    for (const ProfileEvent &event : events) {
+        switch (event.type) {
+            case ProfileEventType::Cpu:
+            case ProfileEventType::Gpu:
+                std::snprintf(line,
+                              sizeof(line),
+                              ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                              event.name,
+                              event.type == ProfileEventType::Gpu ? "gpu" : "cpu",
+                              event.start / 1e3,
+                              event.duration / 1e3,
+                              event.thread);
+                break;
+            case ProfileEventType::Counter:
+                std::snprintf(line,
+                              sizeof(line),
+                              ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%llu}}",
+                              event.name,
+                              event.start / 1e3,
+                              static_cast<unsigned long long>(event.duration));
+                break;
+        }
+        file << line;
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
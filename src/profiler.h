@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+enum class ProfileEventType : uint8_t
+{
+    Cpu,
+    Gpu,
+    Counter
+};
+
+// One timed scope or counter sample. Names must be string literals, only the
+// pointer is stored.
+struct ProfileEvent
+{
+    const char      *name     = nullptr;
+    uint64_t         start    = 0;  // ns since the profiler was created
+    uint64_t         duration = 0;  // ns, or the value for counters
+    uint32_t         thread   = 0;
+    ProfileEventType type     = ProfileEventType::Cpu;
+};
+
+// Fixed-capacity ring of the most recent events. Any thread may Push: a slot is
+// claimed with one atomic increment and published through its sequence number,
+// so writers never block each other and a reader skips slots that are being
+// overwritten instead of waiting for them.
+class ProfileRing
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit ProfileRing(size_t capacity);
+
+    void Push(const ProfileEvent &event);
+
+    // copies the events still held, oldest first
+    void Snapshot(std::vector<ProfileEvent> &out) const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};  // 2 * index + 2 once written, odd while writing
+        ProfileEvent          event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t                  mask;
+    std::atomic<uint64_t>   writeIndex{0};
+};
+
+struct FrameTimePercentiles
+{
+    double p50 = 0.0;  // ms
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Collects CPU scopes, GL_TIME_ELAPSED GPU scopes and per-frame counters into a
+// ProfileRing, keeps a rolling window of frame times for the HUD, and writes
+// everything out as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Disabled by default, a disabled scope costs one branch.
+class Profiler
+{
+public:
+    Profiler();
+
+    // any thread; F3 toggles it on the main thread while the simulation's scopes read it
+    void SetEnabled(bool enabled) { this->enabled.store(enabled, std::memory_order_relaxed); }
+
+    bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // ns since the profiler was created
+    uint64_t Now() const;
+
+    void Record(const char *name, uint64_t start, uint64_t end);
+    void Counter(const char *name, uint64_t value);
+
+    // labels the calling thread in the trace
+    void NameThread(const char *name);
+
+    // GPU timing needs a current GL context, call after glewInit
+    void InitGpu();
+    void DestroyGpu();
+
+    // GL_TIME_ELAPSED queries cannot nest, so GPU scopes must be siblings
+    void BeginGpu(const char *name);
+    void EndGpu();
+
+    // brackets one rendered frame, EndFrame also collects finished GPU queries
+    void BeginFrame();
+    void EndFrame();
+
+    FrameTimePercentiles FramePercentiles();
+
+    // average CPU time of the frames in the window, ms
+    double AverageCpuTime() const;
+
+    // GPU time of the most recent frame whose queries have completed, ms
+    double GpuFrameTime() const { return gpuFrameTime; }
+
+    bool WriteChromeTrace(const std::string &path) const;
+
+private:
+    static constexpr int FRAME_WINDOW  = 240;
+    static constexpr int GPU_FRAME_LAG = 4;  // frames a query may take before we read it
+    static constexpr int GPU_SCOPES    = 8;  // per frame
+    static constexpr int MAX_THREADS   = 16;
+
+    struct GpuFrame
+    {
+        GLuint      queries[GPU_SCOPES] = {};
+        const char *names[GPU_SCOPES]   = {};
+        uint64_t    starts[GPU_SCOPES]  = {};
+        int         count               = 0;
+    };
+
+    void ResolveGpuFrame(GpuFrame &frame);
+
+    std::chrono::steady_clock::time_point origin;
+    std::atomic<bool>                     enabled = false;
+    ProfileRing                           ring;
+
+    std::atomic<const char *> threadNames[MAX_THREADS] = {};
+
+    bool     gpuReady       = false;
+    bool     gpuScopeActive = false;
+    GpuFrame gpuFrames[GPU_FRAME_LAG];
+    uint64_t frameIndex   = 0;
+    double   gpuFrameTime = 0.0;
+
+    uint64_t frameStart               = 0;
+    uint64_t lastFrameEnd             = 0;
+    float    frameTimes[FRAME_WINDOW] = {};  // ms between frame ends
+    float    cpuTimes[FRAME_WINDOW]   = {};  // ms from BeginFrame to EndFrame
+    int      frameCount               = 0;
+    float    sorted[FRAME_WINDOW]     = {};
+};
+
+extern Profiler profiler;
+
+// Records the enclosing block as a CPU event
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name)
+        : name(name)
+        , active(profiler.Enabled())
+        , start(active ? profiler.Now() : 0)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (active) {
+            profiler.Record(name, start, profiler.Now());
+        }
+    }
+
+private:
+    const char *name;
+    bool        active;
+    uint64_t    start;
+};
+
+// Times the enclosing block on the GPU, must not contain another GPU scope
+class GpuProfileScope
+{
+public:
+    explicit GpuProfileScope(const char *name) { profiler.BeginGpu(name); }
+
+    ~GpuProfileScope() { profiler.EndGpu(); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b)       PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name)        ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name)    GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
@@ -0,0 +1,114 @@
+#include "quadBatch.h"
+
+RenderStats renderStats;
+
+void QuadBatch::Init(GLuint quadVBO, StreamBuffer *streamBuffer)
+{
+    stream = streamBuffer;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(vao);
+
+    // shared unit quad
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+
+    // offset, scale and color advance once per instance
+    SetInstanceAttributes(instanceVBO, 0);
+    for (GLuint attrib = 1; attrib <= 3; attrib++) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+// with the VAO bound
+void QuadBatch::SetInstanceAttributes(GLuint buffer, size_t offset)
+{
+    const GLsizei stride = sizeof(QuadInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(QuadInstance, offset)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(QuadInstance, scale)));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(QuadInstance, color)));
+}
+
+void QuadBatch::Destroy()
+{
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &instanceVBO);
+    vao           = 0;
+    instanceVBO   = 0;
+    capacity      = 0;
+    uploadedCount = 0;
+    instances.clear();
+}
+
+void QuadBatch::Add(const Vec2 &offset, const Vec2 &scale, const Vec3 &color)
+{
+    instances.push_back({offset, scale, color});
+}
+
+void QuadBatch::Clear()
+{
+    instances.clear();
+}
+
+void QuadBatch::Upload(GLenum usage)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    if (usage == GL_STATIC_DRAW) {
+        // retained data, size it exactly
+        capacity = instances.size();
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(QuadInstance), instances.data(), usage);
+    } else {
+        // grow geometrically, and orphan the old storage so we never wait on the previous frame's draw
+        if (instances.size() > capacity) {
+            capacity = instances.size() * 2;
+        }
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(QuadInstance), nullptr, usage);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(QuadInstance), instances.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploadedCount = instances.size();
+    renderStats.uploadBytes += static_cast<int>(instances.size() * sizeof(QuadInstance));
+}
+
+void QuadBatch::Draw() const
+{
+    if (uploadedCount == 0) {
+        return;
+    }
+
+    glBindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(uploadedCount));
+
+    renderStats.drawCalls++;
+    renderStats.instances += static_cast<int>(uploadedCount);
+}
+
+void QuadBatch::Flush()
+{
+    if (instances.empty()) {
+        return;
+    }
+
+    if (stream) {
+        // GL 3.3 has no base instance, so the attributes move to where the data landed
+        size_t offset = stream->Write(instances.data(), instances.size() * sizeof(QuadInstance));
+        glBindVertexArray(vao);
+        SetInstanceAttributes(stream->Buffer(), offset);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploadedCount = instances.size();
+    } else {
+        Upload(GL_STREAM_DRAW);
+    }
+    Draw();
+    Clear();
+}
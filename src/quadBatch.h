@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "core/vec.h"
+#include "sceneQuads.h"
+#include "streamBuffer.h"
+
+// Per-frame counters, reset by the main loop
+struct RenderStats
+{
+    int    drawCalls      = 0;
+    int    instances      = 0;
+    int    uniformUploads = 0;
+    int    uploadBytes    = 0;
+    double uploadStall    = 0.0;  // seconds spent waiting for a StreamBuffer region
+};
+
+extern RenderStats renderStats;
+
+// Collects quads on the CPU and draws them with one instanced call, sharing the
+// unit quad VBO. Instances are drawn in the order they were added.
+//
+// Dynamic batches are refilled every frame and submitted with Flush(). Given a
+// stream buffer they write into it and point their instance attributes at the
+// written range, otherwise they orphan their own buffer. A retained batch is
+// filled once, uploaded with GL_STATIC_DRAW, and then redrawn with Draw() until it
+// is cleared and rebuilt.
+class QuadBatch
+{
+public:
+    void Init(GLuint quadVBO, StreamBuffer *stream = nullptr);
+    void Destroy();
+
+    void Add(const Vec2 &offset, const Vec2 &scale, const Vec3 &color);
+    void Clear();
+
+    // for appending many at once, e.g. AppendBoardQuads()
+    std::vector<QuadInstance> &Instances() { return instances; }
+
+    void Upload(GLenum usage);
+    void Draw() const;
+
+    // upload, draw and clear in one go
+    void Flush();
+
+    size_t Size() const { return instances.size(); }
+
+private:
+    void SetInstanceAttributes(GLuint buffer, size_t offset);
+
+    StreamBuffer             *stream        = nullptr;
+    GLuint                    vao           = 0;
+    GLuint                    instanceVBO   = 0;
+    size_t                    capacity      = 0;
+    size_t                    uploadedCount = 0;
+    std::vector<QuadInstance> instances;
+};
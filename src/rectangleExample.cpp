@@ -5,6 +5,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "shader.h"
+
 struct Vec2
 {
     float x = 0.0f;
@@ -64,7 +66,8 @@ auto main() -> int
     // glfwSetWindowPos(window, 256, 256);
     glfwMakeContextCurrent(window);
 
-    if (!glewInit() != GLEW_OK) {
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
         std::cout << "Failed initializing glew" << "\n";
         glfwTerminate();
         return -1;
@@ -87,20 +90,6 @@ auto main() -> int
 		}
 	)";
 
-    GLuint      vertexShader     = glCreateShader(GL_VERTEX_SHADER);
-    const char *vertexShaderCStr = vertexShaderSource.c_str();
-
-    glShaderSource(vertexShader, 1, &vertexShaderCStr, nullptr);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "ERROR:VERTEX_SHADER_COMPILATION_FAILED: " << infoLog << "\n";
-    }
-
     // fragment shader code / runs once per pixel in triangle vertex
     std::string fragmentShaderSource = R"(
 		#version 330 core
@@ -115,33 +104,13 @@ auto main() -> int
 		}
 	)";
 
-    GLuint      fragmentShader           = glCreateShader(GL_FRAGMENT_SHADER);
-    const char *fragmentShaderSourceCStr = fragmentShaderSource.c_str();
-
-    glShaderSource(fragmentShader, 1, &fragmentShaderSourceCStr, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "ERROR:FRAGMENT_SHADER_COMPILATION_FAILED: " << infoLog << "\n";
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "ERROR:SHADER_PROGRAM_LINKING_FAILED: " << infoLog << "\n";
+    ShaderProgram::SetCacheDirectory(DefaultShaderCacheDirectory());
+    ShaderProgram shaderProgram;
+    if (!shaderProgram.Compile(vertexShaderSource, fragmentShaderSource) || !shaderProgram.Finish()) {
+        glfwTerminate();
+        return -1;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
     // clang-format off
     std::vector<float> vertices = {
 		0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
@@ -188,14 +157,14 @@ auto main() -> int
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    GLint uColorLoc  = glGetUniformLocation(shaderProgram, "uColor");
-    GLint uOffsetLoc = glGetUniformLocation(shaderProgram, "uOffset");
+    GLint uColorLoc  = shaderProgram.Uniform("uColor");
+    GLint uOffsetLoc = shaderProgram.Uniform("uOffset");
 
     while (!glfwWindowShouldClose(window)) {
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);  // set buffer bg color
         glClear(GL_COLOR_BUFFER_BIT);          // clears and paint buffer
 
-        glUseProgram(shaderProgram);  // load/binds the pipeline
+        shaderProgram.Use();  // load/binds the pipeline
         glUniform4f(uColorLoc, 0.0f, 1.0f, 0.0f, 1.0f);
         glUniform2f(uOffsetLoc, offset.x, offset.y);
         glBindVertexArray(vao);                               // tells gpu where to get data (VAO reads VBO)
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+
+#include "renderCommands.h"
+
+// sort key fields, from the most significant bits down
+const int   SORT_LAYER_SHIFT     = 56;
+const int   SORT_PROGRAM_SHIFT   = 48;
+const int   SORT_COLOR_SHIFT     = 24;
+const int   SORT_SEQUENCE_BITS   = 24;
+const float COLOR_CHANNEL_LEVELS = 255.0f;
+
+static uint64_t ColorKey(const Vec3 &color)
+{
+    auto channel = [](float value) {
+        return static_cast<uint64_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * COLOR_CHANNEL_LEVELS));
+    };
+    return channel(color.r) << 16 | channel(color.g) << 8 | channel(color.b);
+}
+
+void RenderCommandBuffer::Reset()
+{
+    commands.clear();
+    batches.clear();
+    quads.clear();
+    text.clear();
+}
+
+void RenderCommandBuffer::SetView(float x, float y, float scaleX, float scaleY)
+{
+    view[0] = x;
+    view[1] = y;
+    view[2] = scaleX;
+    view[3] = scaleY;
+}
+
+void RenderCommandBuffer::Add(RenderCommand &command)
+{
+    // quads take their color per instance, so only clears and text sort by it
+    uint64_t color = 0;
+    if (command.type == RenderCommandType::Clear || command.type == RenderCommandType::Text) {
+        color = ColorKey(command.color);
+    }
+    uint64_t sequence = commands.size() & ((uint64_t(1) << SORT_SEQUENCE_BITS) - 1);
+
+    command.sortKey = uint64_t(command.layer) << SORT_LAYER_SHIFT | uint64_t(command.program) << SORT_PROGRAM_SHIFT
+                    | color << SORT_COLOR_SHIFT | sequence;
+    commands.push_back(command);
+}
+
+void RenderCommandBuffer::AddClear(const Vec3 &color)
+{
+    RenderCommand command;
+    command.type    = RenderCommandType::Clear;
+    command.layer   = RenderLayer::Background;
+    command.program = RenderProgram::None;
+    command.color   = color;
+    Add(command);
+}
+
+void RenderCommandBuffer::AddQuads(RenderLayer layer, size_t first)
+{
+    if (first >= quads.size()) {
+        return;
+    }
+
+    RenderCommand command;
+    command.type    = RenderCommandType::Quads;
+    command.layer   = layer;
+    command.program = RenderProgram::Quads;
+    command.first   = static_cast<uint32_t>(first);
+    command.count   = static_cast<uint32_t>(quads.size() - first);
+    Add(command);
+}
+
+void RenderCommandBuffer::AddRetainedQuads(RenderLayer layer, size_t first, bool rebuild)
+{
+    RenderCommand command;
+    command.type    = RenderCommandType::RetainedQuads;
+    command.layer   = layer;
+    command.program = RenderProgram::Quads;
+    command.rebuild = rebuild;
+    command.first   = static_cast<uint32_t>(std::min(first, quads.size()));
+    command.count   = rebuild ? static_cast<uint32_t>(quads.size() - command.first) : 0;
+    Add(command);
+}
+
+void RenderCommandBuffer::AddText(std::string_view string, float x, float y, float scale, const Vec3 &color)
+{
+    RenderCommand command;
+    command.type    = RenderCommandType::Text;
+    command.layer   = RenderLayer::Text;
+    command.program = RenderProgram::Text;
+    command.color   = color;
+    command.first   = static_cast<uint32_t>(text.size());
+    command.count   = static_cast<uint32_t>(string.size());
+    command.x       = x;
+    command.y       = y;
+    command.scale   = scale;
+    text.insert(text.end(), string.begin(), string.end());
+    Add(command);
+}
+
+void RenderCommandBuffer::Sort()
+{
+    // the keys are unique, so std::sort keeps the order added without the
+    // buffer std::stable_sort would allocate
+    std::sort(commands.begin(), commands.end(), [](const RenderCommand &a, const RenderCommand &b) {
+        return a.sortKey < b.sortKey;
+    });
+
+    batches.clear();
+    for (uint32_t i = 0; i < commands.size(); i++) {
+        const RenderCommand &command = commands[i];
+        if (!batches.empty()) {
+            RenderBatch &last = batches.back();
+            if (last.type == command.type && last.layer == command.layer && last.program == command.program) {
+                last.count++;
+                continue;
+            }
+        }
+        batches.push_back({command.type, command.layer, command.program, i, 1});
+    }
+}
+
+std::string_view RenderCommandBuffer::Text(const RenderCommand &command) const
+{
+    return std::string_view(text.data() + command.first, command.count);
+}
+
+const char *RenderLayerName(RenderLayer layer)
+{
+    switch (layer) {
+        case RenderLayer::Background:
+            return "background";
+        case RenderLayer::Board:
+            return "board";
+        case RenderLayer::Cells:
+            return "cells";
+        case RenderLayer::Text:
+            return "text";
+        case RenderLayer::Count:
+            break;
+    }
+    return "?";
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "core/vec.h"
+#include "sceneQuads.h"
+
+// Drawn in this order, whatever order the commands were added in
+enum class RenderLayer : uint8_t
+{
+    Background,
+    Board,
+    Cells,
+    Text,
+    Count
+};
+
+enum class RenderProgram : uint8_t
+{
+    None,  // clears
+    Quads,
+    Text
+};
+
+enum class RenderCommandType : uint8_t
+{
+    Clear,
+    Quads,          // instances for the dynamic batch
+    RetainedQuads,  // the backend's retained batch of the layer, replaced when rebuild is set
+    Text
+};
+
+struct RenderCommand
+{
+    RenderCommandType type;
+    RenderLayer       layer;
+    RenderProgram     program;
+    Vec3              color;  // clear color, or text color
+    bool              rebuild = false;
+    uint32_t          first   = 0;  // quads: range in Quads(), text: range in the character pool
+    uint32_t          count   = 0;
+    float             x       = 0.0f;  // text center and scale
+    float             y       = 0.0f;
+    float             scale   = 0.0f;
+    uint64_t          sortKey = 0;  // layer, program, color, then the order added
+};
+
+// A run of sorted commands that share layer, program and type, so a backend sets
+// its state up once for all of them; quad commands in a batch become one draw.
+struct RenderBatch
+{
+    RenderCommandType type;
+    RenderLayer       layer;
+    RenderProgram     program;
+    uint32_t          first;  // range in Commands()
+    uint32_t          count;
+};
+
+// One frame of rendering as data. The Draw* functions add commands here instead
+// of calling GL, Sort() orders them by state and merges them into batches, and a
+// RenderBackend carries them out: the GL one draws them, the recording one counts
+// and serializes them without a GL context. Quad instances and text live in pools
+// that keep their capacity across Reset(), so steady frames do not allocate.
+class RenderCommandBuffer
+{
+public:
+    // empties the buffer for a new frame
+    void Reset();
+
+    // quad program translation and scale, as uView: xy translation, zw cells to clip space
+    void SetView(float x, float y, float scaleX, float scaleY);
+
+    void AddClear(const Vec3 &color);
+
+    // Quad instances are appended to Quads() and then claimed with AddQuads(),
+    // which takes those added since first, e.g. with AppendSnakeQuads()
+    std::vector<QuadInstance> &Quads() { return quads; }
+    void                       AddQuads(RenderLayer layer, size_t first);
+
+    // draws the layer's retained quads, replacing them with those added since
+    // first when rebuild is set
+    void AddRetainedQuads(RenderLayer layer, size_t first, bool rebuild);
+
+    // text is copied, so it may be freed once this returns
+    void AddText(std::string_view text, float x, float y, float scale, const Vec3 &color);
+
+    // orders the commands by layer, program and color, keeping the order they
+    // were added in otherwise, and groups them into batches
+    void Sort();
+
+    const std::vector<RenderCommand> &Commands() const { return commands; }
+    const std::vector<RenderBatch>   &Batches() const { return batches; }
+    const std::vector<QuadInstance>  &Quads() const { return quads; }
+    std::string_view                  Text(const RenderCommand &command) const;
+
+    const float *View() const { return view; }
+
+private:
+    void Add(RenderCommand &command);
+
+    float                      view[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    std::vector<RenderCommand> commands;
+    std::vector<RenderBatch>   batches;
+    std::vector<QuadInstance>  quads;
+    std::vector<char>          text;
+};
+
+// Carries out a sorted command buffer, e.g. GlRenderBackend or RenderRecorder
+struct RenderBackend
+{
+    void (*execute)(const RenderCommandBuffer &commands, void *context) = nullptr;
+    void *context                                                       = nullptr;
+
+    void Execute(const RenderCommandBuffer &commands) const { execute(commands, context); }
+};
+
+const char *RenderLayerName(RenderLayer layer);
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+#include "renderRecorder.h"
+
+// FNV-1a over instance data, so a log line changes when any quad does
+static uint64_t HashQuads(const QuadInstance *quads, size_t count, uint64_t hash = 14695981039346656037ULL)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(quads);
+    for (size_t i = 0; i < count * sizeof(QuadInstance); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void ExecuteRecorder(const RenderCommandBuffer &commands, void *context)
+{
+    static_cast<RenderRecorder *>(context)->Execute(commands);
+}
+
+RenderBackend RenderRecorder::Backend()
+{
+    return {ExecuteRecorder, this};
+}
+
+void RenderRecorder::Write(const char *format, ...)
+{
+    char    line[512];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = std::vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+
+    if (length > 0) {
+        log.append(line, std::min<size_t>(length, sizeof(line) - 1));
+        log.push_back('\n');
+    }
+}
+
+void RenderRecorder::Execute(const RenderCommandBuffer &commands)
+{
+    const std::vector<RenderCommand> &list  = commands.Commands();
+    const std::vector<QuadInstance>  &quads = commands.Quads();
+
+    lastFrame          = RecordedStats();
+    lastFrame.frames   = 1;
+    lastFrame.commands = list.size();
+    lastFrame.batches  = commands.Batches().size();
+
+    if (serialize) {
+        const float *view = commands.View();
+        Write("frame %llu commands %zu batches %zu",
+              static_cast<unsigned long long>(totals.frames),
+              list.size(),
+              commands.Batches().size());
+        Write("view %.4f %.4f %.6f %.6f", view[0], view[1], view[2], view[3]);
+    }
+
+    for (const RenderBatch &batch : commands.Batches()) {
+        const char *layer = RenderLayerName(batch.layer);
+
+        // dynamic quads of a batch go out in one draw
+        if (batch.type == RenderCommandType::Quads) {
+            uint64_t count = 0;
+            for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                count += list[i].count;
+            }
+            lastFrame.drawCalls += count > 0;
+            lastFrame.quads += count;
+            if (serialize) {
+                uint64_t hash = HashQuads(nullptr, 0);
+                for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                    hash = HashQuads(quads.data() + list[i].first, list[i].count, hash);
+                }
+                Write("quads %s commands %u quads %llu hash %016llx",
+                      layer,
+                      batch.count,
+                      static_cast<unsigned long long>(count),
+                      static_cast<unsigned long long>(hash));
+            }
+            continue;
+        }
+
+        for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+            const RenderCommand &command = list[i];
+            switch (command.type) {
+                case RenderCommandType::Clear: {
+                    if (serialize) {
+                        Write("clear %s %.3f %.3f %.3f", layer, command.color.r, command.color.g, command.color.b);
+                    }
+                } break;
+                case RenderCommandType::RetainedQuads: {
+                    uint32_t &retained = retainedQuads[static_cast<int>(command.layer)];
+                    if (command.rebuild) {
+                        retained = command.count;
+                        lastFrame.rebuilds++;
+                    }
+                    lastFrame.drawCalls += retained > 0;
+                    lastFrame.quads += retained;
+                    if (serialize && command.rebuild) {
+                        uint64_t hash = HashQuads(quads.data() + command.first, command.count);
+                        Write("retained %s rebuild quads %u hash %016llx",
+                              layer,
+                              retained,
+                              static_cast<unsigned long long>(hash));
+                    } else if (serialize) {
+                        Write("retained %s quads %u", layer, retained);
+                    }
+                } break;
+                case RenderCommandType::Text: {
+                    // one draw per string, as the GL backend caches a mesh per string
+                    std::string_view text = commands.Text(command);
+                    scratch.clear();
+                    LayoutText(text, command.x, command.y, command.scale, command.color, scratch);
+                    lastFrame.drawCalls += !scratch.empty();
+                    lastFrame.glyphs += scratch.size();
+                    if (serialize) {
+                        Write("text %s \"%.*s\" at %.4f %.4f scale %.4f color %.3f %.3f %.3f glyphs %zu",
+                              layer,
+                              static_cast<int>(text.size()),
+                              text.data(),
+                              command.x,
+                              command.y,
+                              command.scale,
+                              command.color.r,
+                              command.color.g,
+                              command.color.b,
+                              scratch.size());
+                    }
+                } break;
+                case RenderCommandType::Quads:
+                    break;
+            }
+        }
+    }
+
+    totals.frames++;
+    totals.commands += lastFrame.commands;
+    totals.batches += lastFrame.batches;
+    totals.drawCalls += lastFrame.drawCalls;
+    totals.quads += lastFrame.quads;
+    totals.glyphs += lastFrame.glyphs;
+    totals.rebuilds += lastFrame.rebuilds;
+}
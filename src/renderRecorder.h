@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "renderCommands.h"
+#include "textLayout.h"
+
+// What the GL backend would have done with the frames recorded
+struct RecordedStats
+{
+    uint64_t frames    = 0;
+    uint64_t commands  = 0;
+    uint64_t batches   = 0;
+    uint64_t drawCalls = 0;
+    uint64_t quads     = 0;  // instances drawn, retained ones included
+    uint64_t glyphs    = 0;
+    uint64_t rebuilds  = 0;  // retained layers replaced
+};
+
+// Null backend: carries out command buffers without a GL context, counting the
+// draw calls and instances the GL backend would submit for them, and optionally
+// writing each frame to a text log, one line per command or merged draw, so the
+// streams of two renderer versions can be compared with diff.
+class RenderRecorder
+{
+public:
+    void SetSerialize(bool enabled) { serialize = enabled; }
+
+    void Execute(const RenderCommandBuffer &commands);
+
+    // a RenderBackend that records into this
+    RenderBackend Backend();
+
+    const RecordedStats &LastFrame() const { return lastFrame; }
+    const RecordedStats &Totals() const { return totals; }
+
+    // serialized frames since the last ClearLog()
+    const std::string &Log() const { return log; }
+    void               ClearLog() { log.clear(); }
+
+private:
+    void Write(const char *format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    bool                       serialize = false;
+    RecordedStats              lastFrame;
+    RecordedStats              totals;
+    uint32_t                   retainedQuads[static_cast<int>(RenderLayer::Count)] = {};
+    std::vector<GlyphInstance> scratch;
+    std::string                log;
+};
@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "sceneQuads.h"
+#include "simulation.h"
+
+bool InRange(const CellRange &range, const Vec2i &cell)
+{
+    return cell.x >= range.minX && cell.x <= range.maxX && cell.y >= range.minY && cell.y <= range.maxY;
+}
+
+QuadInstance CellQuad(const Vec2 &position, const Vec3 &color)
+{
+    // quads are in cell units, uView maps them to the screen
+    Vec2 offset(position.x + 0.5f, position.y + 0.5f);
+
+    // slightly smaller than the cell for grid effect
+    Vec2 scale(0.9f, 0.9f);
+
+    return {offset, scale, color};
+}
+
+static QuadInstance CellQuad(const Vec2i &position, const Vec3 &color)
+{
+    return CellQuad(Vec2(static_cast<float>(position.x), static_cast<float>(position.y)), color);
+}
+
+Vec2 InterpolatedSegment(const SimSnapshot &state, size_t i, float alpha)
+{
+    const SnapshotSnake &snake = state.snake;
+
+    Vec2i from = !state.moved ? snake[i] : i + 1 < snake.Size() ? snake[i + 1] : state.previousTail;
+    Vec2i to   = snake[i];
+    return Vec2(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
+}
+
+void AppendBoardQuads(const CellRange &range, int gridWidth, int gridHeight, std::vector<QuadInstance> &out)
+{
+    Vec3 borderColor(0.3f, 0.3f, 0.5f);
+
+    // top and bottom border
+    for (int x = range.minX; x <= range.maxX; x++) {
+        if (range.maxY == gridHeight) {
+            out.push_back(CellQuad(Vec2i(x, gridHeight), borderColor));
+        }
+        if (range.minY == -1) {
+            out.push_back(CellQuad(Vec2i(x, -1), borderColor));
+        }
+    }
+
+    // left and right border, the corners are already drawn
+    for (int y = std::max(range.minY, 0); y <= std::min(range.maxY, gridHeight - 1); y++) {
+        if (range.minX == -1) {
+            out.push_back(CellQuad(Vec2i(-1, y), borderColor));
+        }
+        if (range.maxX == gridWidth) {
+            out.push_back(CellQuad(Vec2i(gridWidth, y), borderColor));
+        }
+    }
+
+    // draw grid lines
+    Vec3 gridColor(0.15f, 0.17f, 0.2f);
+    for (int x = std::max(range.minX, 0); x <= std::min(range.maxX, gridWidth - 1); x++) {
+        for (int y = std::max(range.minY, 0); y <= std::min(range.maxY, gridHeight - 1); y++) {
+            if ((x + y) % 2 == 0) {
+                out.push_back(CellQuad(Vec2i(x, y), gridColor));
+            }
+        }
+    }
+}
+
+void AppendSnakeQuads(const SimSnapshot &state, const CellRange &visible, float alpha, std::vector<QuadInstance> &out)
+{
+    Vec3 headColor(0.0f, 0.95f, 0.3f);
+    Vec3 bodyColor(0.0f, 0.7f, 0.1f);
+
+    const SnapshotSnake &snake = state.snake;
+
+    // draw body, segments off screen are skipped but still cost a range check
+    for (size_t i = 1; i < snake.Size(); i++) {
+        if (!InRange(visible, snake[i])) {
+            continue;
+        }
+
+        float factor = static_cast<float>(i) / snake.Size();
+        Vec3  segmentColor(bodyColor.r * (1.0f - factor) + 0.1f * factor,
+                          bodyColor.g * (1.0f - factor) + 0.8f * factor,
+                          bodyColor.b * (1.0f - factor));
+
+        out.push_back(CellQuad(InterpolatedSegment(state, i, alpha), segmentColor));
+    }
+
+    // draw head
+    out.push_back(CellQuad(InterpolatedSegment(state, 0, alpha), headColor));
+
+    // draw fruit
+    out.push_back(CellQuad(state.fruit, Vec3(1.0f, 0.3f, 0.3f)));  // red
+}
+
+void AppendGameOverQuads(const CellRange &visible, int gridWidth, int gridHeight, std::vector<QuadInstance> &out)
+{
+    for (int x = std::max(visible.minX, 0); x <= std::min(visible.maxX, gridWidth - 1); x++) {
+        for (int y = std::max(visible.minY, 0); y <= std::min(visible.maxY, gridHeight - 1); y++) {
+            out.push_back(CellQuad(Vec2i(x, y), Vec3(0.2f, 0.1f, 0.1f)));
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/vec.h"
+
+struct SimSnapshot;
+
+// One unit quad instance, laid out to match vertex attributes 1..3
+struct QuadInstance
+{
+    Vec2 offset;
+    Vec2 scale;
+    Vec3 color;
+};
+
+static_assert(sizeof(QuadInstance) == 7 * sizeof(float), "QuadInstance must be tightly packed");
+
+// Cells are drawn in board coordinates and mapped to the screen by uView
+struct CellRange
+{
+    int minX = 0;
+    int minY = 0;
+    int maxX = -1;  // inclusive
+    int maxY = -1;
+};
+
+// The quads of a frame, worked out without GL so they can be built, counted and
+// timed anywhere. The game hands these the instance list of a QuadBatch.
+
+bool InRange(const CellRange &range, const Vec2i &cell);
+
+// a board cell as a quad, fractional positions land between cells
+QuadInstance CellQuad(const Vec2 &position, const Vec3 &color);
+
+// Segment i slid alpha of the way from where it was on the previous tick; a
+// segment added by eating has no previous position and starts on the old tail,
+// which did not move
+Vec2 InterpolatedSegment(const SimSnapshot &state, size_t i, float alpha);
+
+// the border and checkerboard inside range of a gridWidth x gridHeight board
+void AppendBoardQuads(const CellRange &range, int gridWidth, int gridHeight, std::vector<QuadInstance> &out);
+
+// body, head and fruit; body segments outside visible are skipped
+void AppendSnakeQuads(const SimSnapshot &state, const CellRange &visible, float alpha, std::vector<QuadInstance> &out);
+
+// the dimmed board behind the game-over text
+void AppendGameOverQuads(const CellRange &visible, int gridWidth, int gridHeight, std::vector<QuadInstance> &out);
@@ -0,0 +1,266 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "shader.h"
+
+const int LOG_SIZE = 512;
+
+static std::string cacheDirectory;
+static bool        parallelCompile = false;
+
+// FNV-1a, stable across runs and platforms, unlike std::hash
+static uint64_t HashString(uint64_t hash, const char *text)
+{
+    for (const char *c = text; *c; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 0x100000001b3ULL;
+    }
+    return (hash ^ 0xff) * 0x100000001b3ULL;  // separator, so "ab"+"c" differs from "a"+"bc"
+}
+
+static bool BinaryCacheSupported()
+{
+    if (cacheDirectory.empty() || !GLEW_ARB_get_program_binary) {
+        return false;
+    }
+
+    // some drivers expose the entry points without any format to store
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static GLuint CompileShader(GLenum type, const std::string &source)
+{
+    GLuint      shader    = glCreateShader(type);
+    const char *sourceStr = source.c_str();
+    glShaderSource(shader, 1, &sourceStr, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+static bool CheckShader(GLuint shader, const char *errorTag)
+{
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[LOG_SIZE];
+        glGetShaderInfoLog(shader, LOG_SIZE, nullptr, infoLog);
+        std::cerr << errorTag << ": " << infoLog << "\n";
+    }
+    return success;
+}
+
+void ShaderProgram::SetCacheDirectory(const std::string &directory)
+{
+    cacheDirectory = directory;
+}
+
+void ShaderProgram::EnableParallelCompile()
+{
+    // 0xFFFFFFFF lets the driver pick the thread count
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallelCompile = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallelCompile = true;
+    }
+}
+
+bool ShaderProgram::Compile(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    Destroy();
+
+    if (BinaryCacheSupported()) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        hash          = HashString(hash, vertexSource.c_str());
+        hash          = HashString(hash, fragmentSource.c_str());
+        hash          = HashString(hash, reinterpret_cast<const char *>(glGetString(GL_VENDOR)));
+        hash          = HashString(hash, reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+        hash          = HashString(hash, reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+        cachePath = cacheDirectory + "/" + name;
+
+        if (LoadBinary()) {
+            return true;
+        }
+    }
+
+    // nothing is queried until Finish, so with parallel compile none of this blocks
+    vertexShader   = CompileShader(GL_VERTEX_SHADER, vertexSource);
+    fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    if (!cachePath.empty()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+
+    return program != 0;
+}
+
+bool ShaderProgram::Ready() const
+{
+    if (!parallelCompile || fromCache || !program) {
+        return true;
+    }
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+bool ShaderProgram::Finish()
+{
+    if (!program) {
+        return false;
+    }
+    if (fromCache) {
+        return true;
+    }
+
+    // check linking, which waits for the compile if it is still running
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // the link log rarely says more than that a stage failed, so print the stage logs too
+        CheckShader(vertexShader, "ERROR:VERTEX_SHADER_COMPILATION_FAILED");
+        CheckShader(fragmentShader, "ERROR:FRAGMENT_SHADER_COMPILATION_FAILED");
+
+        GLchar infoLog[LOG_SIZE];
+        glGetProgramInfoLog(program, LOG_SIZE, nullptr, infoLog);
+        std::cerr << "ERROR:SHADER_PROGRAM_LINKING_FAILED: " << infoLog << "\n";
+        Destroy();
+        return false;
+    }
+
+    // clean up shaders
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    vertexShader   = 0;
+    fragmentShader = 0;
+
+    if (!cachePath.empty()) {
+        SaveBinary();
+    }
+    return true;
+}
+
+void ShaderProgram::Destroy()
+{
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    glDeleteProgram(program);
+    program        = 0;
+    vertexShader   = 0;
+    fragmentShader = 0;
+    fromCache      = false;
+    cachePath.clear();
+    uniforms.clear();
+}
+
+GLint ShaderProgram::Uniform(const char *name)
+{
+    for (const auto &[uniformName, location] : uniforms) {
+        if (uniformName == name) {
+            return location;
+        }
+    }
+
+    GLint location = glGetUniformLocation(program, name);
+    uniforms.emplace_back(name, location);
+    return location;
+}
+
+// file layout: binary format as a native uint32_t, then the driver's blob
+bool ShaderProgram::LoadBinary()
+{
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() <= sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint32_t format;
+    std::memcpy(&format, bytes.data(), sizeof(format));
+
+    program = glCreateProgram();
+    glProgramBinary(program,
+                    format,
+                    bytes.data() + sizeof(format),
+                    static_cast<GLsizei>(bytes.size() - sizeof(format)));
+
+    // a driver update can reject old binaries even with the same version string
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        program = 0;
+        return false;
+    }
+
+    fromCache = true;
+    return true;
+}
+
+void ShaderProgram::SaveBinary() const
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> bytes(sizeof(uint32_t) + length);
+    GLenum            format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, bytes.data() + sizeof(uint32_t));
+    uint32_t format32 = format;
+    std::memcpy(bytes.data(), &format32, sizeof(format32));
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    // written under a temporary name, so a concurrent start never reads half a file
+    std::string   tempPath = cachePath + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    file.close();
+    if (!file) {
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+    std::filesystem::rename(tempPath, cachePath, error);
+}
+
+std::string DefaultShaderCacheDirectory()
+{
+#if defined(_WIN32)
+    if (const char *localAppData = std::getenv("LOCALAPPDATA")) {
+        return std::string(localAppData) + "/chad-snake/shaders";
+    }
+#else
+    if (const char *cacheHome = std::getenv("XDG_CACHE_HOME")) {
+        return std::string(cacheHome) + "/chad-snake/shaders";
+    }
+    if (const char *home = std::getenv("HOME")) {
+        return std::string(home) + "/.cache/chad-snake/shaders";
+    }
+#endif
+    return "";
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Vertex/fragment program with cached uniform locations.
+//
+// Linked programs are written with glGetProgramBinary to the cache directory,
+// keyed by a hash of both sources and the GL vendor, renderer and version
+// strings, and loaded from there on the next start instead of being compiled.
+// Where GL_KHR_parallel_shader_compile is available Compile() only submits the
+// work; Ready() polls for completion and Finish() collects the result, so the
+// caller can keep presenting frames meanwhile.
+class ShaderProgram
+{
+public:
+    // starts compiling, or loads the cached binary; false only on immediate failure
+    bool Compile(const std::string &vertexSource, const std::string &fragmentSource);
+
+    // true once Finish() would not block
+    bool Ready() const;
+
+    // waits for the link, logs errors and saves the binary, false if the program is unusable
+    bool Finish();
+
+    void Destroy();
+
+    void Use() const { glUseProgram(program); }
+
+    GLuint Id() const { return program; }
+
+    bool FromCache() const { return fromCache; }
+
+    // looked up once per name
+    GLint Uniform(const char *name);
+
+    // an empty directory disables the cache
+    static void SetCacheDirectory(const std::string &directory);
+
+    // asks the driver for compiler threads, call once after the context is current
+    static void EnableParallelCompile();
+
+private:
+    bool LoadBinary();
+    void SaveBinary() const;
+
+    GLuint      program        = 0;
+    GLuint      vertexShader   = 0;
+    GLuint      fragmentShader = 0;
+    bool        fromCache      = false;
+    std::string cachePath;
+
+    std::vector<std::pair<std::string, GLint>> uniforms;
+};
+
+// per-user cache location, $XDG_CACHE_HOME/chad-snake/shaders or the platform equivalent
+std::string DefaultShaderCacheDirectory();
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "profiler.h"
+#include "simulation.h"
+
+Simulation::~Simulation()
+{
+    Stop();
+}
+
+void Simulation::Configure(const SimConfig &newConfig)
+{
+    config = newConfig;
+    game   = GameState(config.width, config.height);
+    autopilot.reset();
+    if (config.autopilot && !config.replayHeader) {
+        autopilot.emplace(config.width, config.height);
+    }
+    Reset();
+}
+
+void Simulation::Launch(void (*publishCallback)())
+{
+    onPublish  = publishCallback;
+    launchTime = std::chrono::steady_clock::now();
+    launched   = true;
+    thread     = std::thread(&Simulation::Run, this);
+}
+
+void Simulation::Stop()
+{
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    // keep a game that was still running when the window closed
+    if (started) {
+        SaveReplay();
+    }
+}
+
+void Simulation::Advance(double deltaTime)
+{
+    virtualTime += deltaTime;
+    ProcessCommands();
+    Update(deltaTime);
+}
+
+void Simulation::RequestStart()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        startRequested = true;
+    }
+    wake.notify_one();
+}
+
+void Simulation::RequestReset()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        resetRequested = true;
+    }
+    wake.notify_one();
+}
+
+double Simulation::Clock() const
+{
+    if (!launched) {
+        return virtualTime;
+    }
+    return virtualTime + std::chrono::duration<double>(std::chrono::steady_clock::now() - launchTime).count();
+}
+
+// Sleeps until the next tick is due, or until a command arrives while nothing is
+// ticking. Frames do not come into it, so a stalled render thread costs no ticks.
+void Simulation::Run()
+{
+    profiler.NameThread("sim");
+
+    double lastTime = Clock();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (stopping) {
+                break;
+            }
+        }
+
+        ProcessCommands();
+
+        double now = Clock();
+        Update(now - lastTime);
+        lastTime = now;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        auto pending = [this] { return stopping || startRequested || resetRequested; };
+        if (Ticking()) {
+            wake.wait_for(lock, std::chrono::duration<double>(scheduler.TimeToNextTick(game.snakeSpeed)), pending);
+        } else {
+            wake.wait(lock, pending);
+        }
+    }
+}
+
+void Simulation::ProcessCommands()
+{
+    bool start;
+    bool reset;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        start          = startRequested;
+        reset          = resetRequested;
+        startRequested = false;
+        resetRequested = false;
+    }
+
+    // R restarts after a game over, or at any time while watching a replay
+    if (reset && (game.gameOver || replayPlayer)) {
+        SaveReplay();
+        Reset();
+    }
+    if (start && !started) {
+        Start();
+    }
+}
+
+bool Simulation::Ticking() const
+{
+    // a replay of an unfinished game stops where the recording did
+    bool replayEnded = replayPlayer && game.tick >= config.replayHeader->tickCount;
+    return started && !game.gameOver && !replayEnded;
+}
+
+void Simulation::Update(double deltaTime)
+{
+    if (!Ticking()) {
+        scheduler.Reset();
+        clockRunning = false;
+        return;
+    }
+
+    // the clock starts with the game, time spent on the start screen does not
+    // count, so the first tick is a full interval out
+    if (!clockRunning) {
+        clockRunning = true;
+        return;
+    }
+
+    // run every tick that is due, leftover time carries into the next update
+    bool ticked = false;
+    scheduler.Advance(deltaTime);
+    while (!game.gameOver && scheduler.Consume(game.snakeSpeed)) {
+        PROFILE_SCOPE("Tick");
+
+        Vec2i  head   = game.snake.Head();
+        Vec2i  tail   = game.snake.Tail();
+        size_t length = game.snake.Size();
+
+        // one queued turn per tick, checked against the heading as it is now
+        Direction  direction = Direction::None;
+        InputEvent turn;
+        if (replayPlayer) {
+            direction = replayPlayer->InputFor(game.tick);
+        } else if (autopilot) {
+            direction = autopilot->Decide(game);
+        } else if (PopTurn(input, game.snakeDir, turn)) {
+            direction                           = turn.direction;
+            turnTimes[turns % turnTimes.size()] = turn.time;
+            turns++;
+        }
+
+        recorder.Record(game.tick, direction);
+        Step(game, direction);
+        ticked = true;
+
+        // a tick that ends the game leaves the snake where it was
+        snakeMoved = !(game.snake.Head() == head);
+        if (snakeMoved) {
+            snakeMoves[snakeVersion % SNAKE_HISTORY] = {game.snake.Head(), game.snake.Size() == length};
+            snakeVersion++;
+            previousTail = tail;
+        }
+    }
+
+    if (!ticked) {
+        return;
+    }
+
+    if (game.gameOver) {
+        SaveReplay();
+    } else {
+        // how far past its due time the last tick ran
+        double lateness = game.snakeSpeed - scheduler.TimeToNextTick(game.snakeSpeed);
+        latenessSum += lateness;
+        latenessMax = std::max(latenessMax, lateness);
+        latenessCount++;
+    }
+    Publish();
+}
+
+void Simulation::Reset()
+{
+    // fresh seed per game, the simulation is deterministic from here on
+    static std::random_device rd;
+    uint64_t                  seed = config.fixedSeed ? config.seed : (static_cast<uint64_t>(rd()) << 32) | rd();
+
+    if (config.replayHeader) {
+        seed = config.replayHeader->seed;
+        replayPlayer.emplace(*config.replayHeader, config.replayEvents);
+    }
+
+    ResetGame(game, seed);
+    if (autopilot) {
+        autopilot->Reset();
+    }
+    if (!config.recordFile.empty()) {
+        recorder.Begin(seed, game);
+    }
+    input.Clear();
+    started      = false;
+    clockRunning = false;
+    scheduler.Reset();
+
+    snakeVersion++;
+    snakeResetVersion = snakeVersion;
+    snakeMoved        = false;
+    Publish();
+}
+
+void Simulation::Start()
+{
+    started       = true;
+    game.snakeDir = replayPlayer ? config.replayHeader->startDirection : Direction::Right;
+    recorder.SetStartDirection(game.snakeDir);
+    Publish();
+}
+
+// fills the back slot, whose snake only needs the moves made since that slot was
+// last published rather than a copy of every segment
+void Simulation::Publish()
+{
+    SimSnapshot &snapshot = snapshots.Back();
+
+    snapshot.screen       = !started ? SimScreen::Start : game.gameOver ? SimScreen::GameOver : SimScreen::Playing;
+    snapshot.gameWon      = game.gameWon;
+    snapshot.replayEnded  = started && !game.gameOver && !Ticking();
+    snapshot.score        = game.score;
+    snapshot.fruit        = game.fruit;
+    snapshot.tick         = game.tick;
+    snapshot.tickInterval = game.snakeSpeed;
+    snapshot.turns        = turns;
+    snapshot.turnTimes    = turnTimes;
+
+    // the tick shown was due when the time left over from it started accumulating
+    snapshot.tickTime = Clock();
+    if (clockRunning) {
+        snapshot.tickTime -= game.snakeSpeed - scheduler.TimeToNextTick(game.snakeSpeed);
+    }
+
+    // a slot the reader held on to for longer than the history copies the snake
+    SnapshotSnake &snake = snapshot.snake;
+    if (snapshot.snakeVersion < snakeResetVersion || snakeVersion - snapshot.snakeVersion > SNAKE_HISTORY) {
+        snake.Assign(game.snake);
+    } else {
+        for (uint64_t version = snapshot.snakeVersion; version < snakeVersion; version++) {
+            const SnakeMove &move = snakeMoves[version % SNAKE_HISTORY];
+            if (move.popped) {
+                snake.PopTail();
+            }
+            snake.PushHead(move.head);
+        }
+    }
+    snapshot.snakeVersion = snakeVersion;
+    snapshot.moved        = snakeMoved;
+    snapshot.previousTail = previousTail;
+
+    snapshots.Publish();
+    if (onPublish) {
+        onPublish();
+    }
+}
+
+// appends the game in progress to the record file, once per game
+void Simulation::SaveReplay()
+{
+    if (!recorder.Active()) {
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    recorder.Finish(game, bytes);
+
+    std::ofstream file(config.recordFile, std::ios::binary | std::ios::app);
+    file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        std::cout << "Failed to write replay to " << config.recordFile << "\n";
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/autopilot.h"
+#include "core/fixedStep.h"
+#include "core/gameState.h"
+#include "core/inputQueue.h"
+#include "core/replay.h"
+#include "core/snapshotSnake.h"
+#include "core/tripleBuffer.h"
+#include "core/vec.h"
+
+enum class SimScreen
+{
+    Start,
+    Playing,
+    GameOver
+};
+
+// What the renderer sees of the game after a tick. Published as a whole, so the
+// GL thread never reads GameState while the simulation is changing it.
+struct SimSnapshot
+{
+    static constexpr size_t TURN_HISTORY = 16;
+
+    SimScreen          screen       = SimScreen::Start;
+    bool               gameWon      = false;
+    bool               replayEnded  = false;  // an unfinished replay ran out of ticks
+    int                score        = 0;
+    Vec2i              fruit        = Vec2i(0, 0);
+    uint64_t           tick         = 0;
+    double             tickTime     = 0.0;  // Simulation::Clock() when the tick shown was due
+    float              tickInterval = 0.0f;
+    SnapshotSnake      snake;
+    uint64_t           snakeVersion = 0;  // Simulation's count of snake changes this slot has caught up with
+
+    // for interpolation: segment i was where segment i + 1 is now and the last
+    // one was at previousTail, unless the snake did not move on the last tick
+    bool  moved        = false;
+    Vec2i previousTail = Vec2i(0, 0);
+
+    // press time of turn n is turnTimes[n % TURN_HISTORY], for the input latency
+    uint64_t                           turns     = 0;
+    std::array<uint64_t, TURN_HISTORY> turnTimes = {};
+};
+
+struct SimConfig
+{
+    int                 width        = GRID_WIDTH;
+    int                 height       = GRID_HEIGHT;
+    bool                fixedSeed    = false;
+    uint64_t            seed         = 0;
+    std::string         recordFile;               // every game played is appended here
+    const ReplayHeader *replayHeader = nullptr;  // plays this game back instead of the arrow keys
+    const uint8_t      *replayEvents = nullptr;
+    bool                autopilot    = false;  // the Autopilot steers instead of the arrow keys, not in replays
+};
+
+// Owns the game and runs its ticks, either on a thread of its own (Launch) or from
+// the caller's frame loop (Advance), which headless runs use so they play out the
+// same way every time. Every change is published as a SimSnapshot through a triple
+// buffer, arrow keys arrive through the InputQueue and start and reset requests
+// through Request*(), so neither thread waits for the other and the tick rate does
+// not follow the frame rate.
+class Simulation
+{
+public:
+    ~Simulation();
+
+    // resets to the start screen and publishes it
+    void Configure(const SimConfig &config);
+
+    // runs ticks on a new thread until Stop(); onPublish is called on that thread
+    // after every snapshot, e.g. to wake a render loop blocked in glfwWaitEvents
+    void Launch(void (*onPublish)() = nullptr);
+
+    // joins the thread and saves a game that was still running
+    void Stop();
+
+    // runs the ticks due after deltaTime more seconds on the calling thread, for
+    // when the simulation was not launched
+    void Advance(double deltaTime);
+
+    // any thread, ignored when they do not apply to the current screen
+    void RequestStart();
+    void RequestReset();
+
+    // producer end is the caller's, the simulation pops one turn per tick
+    InputQueue &Input() { return input; }
+
+    // reader end is the caller's
+    TripleBuffer<SimSnapshot> &Snapshots() { return snapshots; }
+
+    // seconds on the simulation's clock, wall time once launched and the sum of
+    // Advance() calls before; compare with SimSnapshot::tickTime
+    double Clock() const;
+
+    // statistics, read once the simulation has stopped
+    uint64_t Ticks() const { return scheduler.Ticks(); }
+    uint64_t DroppedTicks() const { return scheduler.DroppedTicks(); }
+    double   AverageLateness() const { return latenessCount > 0 ? latenessSum / latenessCount : 0.0; }
+    double   MaxLateness() const { return latenessMax; }
+
+private:
+    void Run();
+    void ProcessCommands();
+    void Update(double deltaTime);
+    void Reset();
+    void Start();
+    bool Ticking() const;
+    void Publish();
+    void SaveReplay();
+
+    SimConfig                   config;
+    GameState                   game;
+    bool                        started      = false;
+    bool                        clockRunning = false;
+    FixedStepScheduler          scheduler;
+    InputQueue                  input;
+    ReplayRecorder              recorder;
+    std::optional<ReplayPlayer> replayPlayer;
+    std::optional<Autopilot>    autopilot;
+    TripleBuffer<SimSnapshot>   snapshots;
+
+    uint64_t                                        turns     = 0;
+    std::array<uint64_t, SimSnapshot::TURN_HISTORY> turnTimes = {};
+
+    // the last SNAKE_HISTORY moves, move n at snakeMoves[n % SNAKE_HISTORY], which
+    // slots apply when they are published again; a reset makes them copy the snake
+    struct SnakeMove
+    {
+        Vec2i head;
+        bool  popped;
+    };
+    static constexpr size_t              SNAKE_HISTORY     = 16;
+    std::array<SnakeMove, SNAKE_HISTORY> snakeMoves        = {};
+    uint64_t                             snakeVersion      = 0;
+    uint64_t                             snakeResetVersion = 0;
+    bool                                 snakeMoved        = false;
+    Vec2i                                previousTail      = Vec2i(0, 0);
+
+    // how late the thread woke for its ticks, seconds
+    double   latenessSum   = 0.0;
+    double   latenessMax   = 0.0;
+    uint64_t latenessCount = 0;
+
+    // clock
+    std::chrono::steady_clock::time_point launchTime;
+    double                                virtualTime = 0.0;
+    bool                                  launched    = false;
+
+    // thread, commands are rare and go through the mutex so they can wake it
+    std::thread             thread;
+    std::mutex              wakeMutex;
+    std::condition_variable wake;
+    bool                    stopping       = false;
+    bool                    startRequested = false;
+    bool                    resetRequested = false;
+
+    void (*onPublish)() = nullptr;
+};
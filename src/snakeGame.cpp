@@ -1,201 +1,241 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <map>
-#include <random>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
-// Simple vector structures
-struct Vec2
-{
-    float x, y;
-
-    Vec2()
-        : x(0.0f)
-        , y(0.0f)
-    {
-    }
-
-    Vec2(float x, float y)
-        : x(x)
-        , y(y)
-    {
-    }
-};
-
-struct Vec2i
-{
-    int x, y;
-
-    Vec2i()
-        : x(0)
-        , y(0)
-    {
-    }
-
-    Vec2i(int x, int y)
-        : x(x)
-        , y(y)
-    {
-    }
-
-    bool operator==(const Vec2i &other) const { return x == other.x && y == other.y; }
-};
-
-struct Vec3
-{
-    float r, g, b;
-
-    Vec3()
-        : r(0.0f)
-        , g(0.0f)
-        , b(0.0f)
-    {
-    }
-
-    Vec3(float r, float g, float b)
-        : r(r)
-        , g(g)
-        , b(b)
-    {
-    }
-};
+#include "core/allocationTracker.h"
+#include "core/frameArena.h"
+#include "core/gameState.h"
+#include "core/inputQueue.h"
+#include "core/mappedFile.h"
+#include "core/replay.h"
+#include "core/vec.h"
+#include "framePacer.h"
+#include "glRenderBackend.h"
+#include "offscreen.h"
+#include "profiler.h"
+#include "quadBatch.h"
+#include "renderCommands.h"
+#include "renderRecorder.h"
+#include "sceneQuads.h"
+#include "shader.h"
+#include "simulation.h"
+#include "textRenderer.h"
 
 // window constatns
 const int   WINDOW_WIDTH  = 800;
 const int   WINDOW_HEIGHT = 800;
 const char *WINDOW_TITLE  = "Chad Snake";
 
-// Game constants
-const int   GRID_WIDTH      = 20;
-const int   GRID_HEIGHT     = 20;
-const float UPDATE_INTERVAL = 0.15f;  // seconds
-const float CELL_WIDTH      = 2.0f / GRID_WIDTH;
-const float CELL_HEIGHT     = 2.0f / GRID_HEIGHT;
-const int   FONT_WIDTH      = 5;
-const int   FONT_HEIGHT     = 5;
-const int   FONT_SPACING    = 1;
-const int   LOG_SIZE        = 512;
-
-// Game state
-enum class Direction
-{
-    Up,
-    Down,
-    Left,
-    Right,
-    None
-};
-
-Vec2i              fruit;
-Direction          snakeDir            = Direction::None;
-std::vector<Vec2i> snake               = {Vec2i(5, 10), Vec2i(4, 10), Vec2i(3, 10)};
-int                score               = 0;
-bool               gameOver            = false;
-bool               gameStarted         = false;
-float              timeSinceLastUpdate = 0.0f;
-float              snakeSpeed          = UPDATE_INTERVAL;
-int                gFbWidth            = WINDOW_WIDTH;
-int                gFbHeight           = WINDOW_HEIGHT;
+// Camera constants, in cells across the shorter side of the window
+const float DEFAULT_VIEW_CELLS = 32.0f;
+const float MIN_VIEW_CELLS     = 8.0f;
+const float MAX_VIEW_CELLS     = 256.0f;  // bounds the number of visible quads on large boards
+const float ZOOM_STEP          = 1.25f;
+
+// The game runs on its own thread and the frame loop draws the latest snapshot it
+// published, headless runs step it from the frame loop instead. --grid WxH picks
+// the board size.
+int        gridWidth  = GRID_WIDTH;
+int        gridHeight = GRID_HEIGHT;
+Simulation simulation;
+int        gFbWidth  = WINDOW_WIDTH;
+int        gFbHeight = WINDOW_HEIGHT;
+
+// Arrow keys are queued with the time they were seen and applied one per tick,
+// --input-depth N sets how many may wait. Once a frame showing a turn has been
+// presented, the time since its press is the input latency. The summary covers
+// the last LATENCY_SAMPLES turns.
+const size_t LATENCY_SAMPLES = 4096;
+
+long                                droppedPresses = 0;
+uint64_t                            presentedTurns = 0;
+std::array<double, LATENCY_SAMPLES> turnLatencies;  // seconds, overwritten oldest first
+uint64_t                            latencyCount    = 0;
+double                              lastTurnLatency = 0.0;
+
+// the snapshot's previous snake is drawn blended towards the current one by tickAlpha
+float tickAlpha = 0.0f;
+
+// Transient data of the frame being drawn, such as formatted text, reset at its
+// start. Together with the reused batches and snapshots this keeps frames off the
+// heap once the snake stops growing; the exit summary and headless runs count
+// heap allocations per frame to check.
+FrameArena frameArena;
+long       allocatingFrames = 0;
+uint64_t   frameAllocations = 0;
+
+// The camera follows the head and shows viewCells cells across the shorter side
+// of the window, or centres the board along an axis where it fits.
+float     cameraX    = 0.0f;
+float     cameraY    = 0.0f;
+float     viewCells  = DEFAULT_VIEW_CELLS;
+float     viewWidth  = DEFAULT_VIEW_CELLS;  // cells across the window, after aspect
+float     viewHeight = DEFAULT_VIEW_CELLS;
+CellRange visibleCells;
+CellRange boardLayerCells;  // what the retained board layer was built for
+
+// Frame pacing, chosen on the command line. With renderOnChange the loop sleeps
+// in glfwWaitEvents, which the simulation interrupts when it publishes, and only
+// draws when frameDirty has been set.
+FramePacer framePacer;
+bool       renderOnChange = false;
+bool       frameDirty     = true;
+
+// Profiling: --profile records, --trace FILE also writes a Chrome trace on exit,
+// --hud or F3 shows the overlay
+bool        showProfilerHud = false;
+std::string traceFile;
+RenderStats lastFrameStats;
+char        hudLines[3][128];
+double      hudNextUpdate = 0.0;
+
+// Replays: --record FILE appends every game played to an archive, --replay FILE
+// plays the first game of one back instead of reading the arrow keys
+std::string    recordFile;
+std::string    replayPath;
+MappedFile     replayFile;
+ReplayHeader   replayHeader;
+const uint8_t *replayEvents = nullptr;
+
+// --autopilot lets the Autopilot play instead of the arrow keys, e.g. to watch or
+// render a long snake; Space starts and R restarts as usual
+bool autopilot = false;
+
+// Headless runs: --headless draws into an offscreen framebuffer on GLFW's null
+// platform and plays a scripted session at a fixed frame rate, --capture DIR writes
+// the start, in-game and game-over frames as PNG and --golden DIR compares them with
+// stored images. --bench-frames N renders N in-game frames as fast as possible.
+const double HEADLESS_FRAME_TIME   = 1.0 / 60.0;
+const int    HEADLESS_INGAME_FRAME = 30;
+const int    HEADLESS_MAX_FRAMES   = 60 * 60 * 10;
+const int    HEADLESS_GROWTH_TICKS = 4;      // ticks after the snake grows that may allocate
+const int    GOLDEN_TOLERANCE      = 16;     // per channel, software rasterizers differ slightly
+const double GOLDEN_MAX_DIFFERING  = 0.002;  // fraction of pixels allowed past the tolerance
+
+bool            headless     = false;
+std::string     captureDir;
+std::string     goldenDir;
+bool            updateGolden = false;
+int             benchFrames  = 0;
+bool            fixedSeed    = false;
+uint64_t        gameSeed     = 0;
+OffscreenTarget offscreen;
+
 // Shader sources
 std::string vertexShaderSource = R"(
     #version 330 core
     layout (location = 0) in vec2 aPos;
-    uniform vec2 uOffset;
-    uniform vec2 uScale;
+    layout (location = 1) in vec2 aOffset;
+    layout (location = 2) in vec2 aScale;
+    layout (location = 3) in vec3 aColor;
+    uniform vec4 uView;  // xy: translation, zw: cells to clip space
+    out vec3 vColor;
     
     void main() {
-        vec2 position = (aPos * uScale) + uOffset;
-        gl_Position = vec4(position, 0.0, 1.0);
+        vec2 position = (aPos * aScale) + aOffset;
+        gl_Position = vec4(position * uView.zw + uView.xy, 0.0, 1.0);
+        vColor = aColor;
     }
 )";
 
 std::string fragmentShaderSource = R"(
     #version 330 core
+    in vec3 vColor;
     out vec4 FragColor;
-    uniform vec3 uColor;
     
     void main() {
-        FragColor = vec4(uColor, 1.0);
+        FragColor = vec4(vColor, 1.0);
     }
 )";
 
 // OpenGL objects
-GLuint shaderProgram;
-GLuint VAO, VBO;
-GLuint uOffsetLoc, uScaleLoc, uColorLoc;
-
-// Bitmap font - each character is 5x5 pixels
-
-// Character definitions (0 = empty, 1 = filled)
-std::map<char, std::vector<int>> fontMap = {
-    {' ', {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
-    {'A', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0}},
-    {'B', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0}},
-    {'C', {0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 0}},
-    {'D', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0}},
-    {'E', {1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 1, 0}},
-    {'F', {1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0}},
-    {'G', {0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0}},
-    {'H', {1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0}},
-    {'I', {1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0}},
-    {'J', {0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'K', {1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
-    {'L', {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 1, 0}},
-    {'M', {1, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0, 1}},
-    {'N', {1, 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 0, 1}},
-    {'O', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'P', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0}},
-    {'Q', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 1, 0}},
-    {'R', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
-    {'S', {0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 0}},
-    {'T', {1, 1, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0}},
-    {'U', {1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'V', {1, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0}},
-    {'W', {1, 0, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0}},
-    {'X', {1, 0, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1}},
-    {'Y', {1, 0, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0}},
-    {'Z', {1, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1, 1}},
-    {'0', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'1', {0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0}},
-    {'2', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1, 0}},
-    {'3', {1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 0}},
-    {'4', {0, 0, 1, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0}},
-    {'5', {1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 0}},
-    {'6', {0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'7', {1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0}},
-    {'8', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {'9', {0, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
-    {':', {0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0}},
-    {'-', {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
-    {'.', {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0}}
-};
+ShaderProgram   quadProgram;
+GLuint          VBO;
+StreamBuffer    streamBuffer;
+TextRenderer    textRenderer;
+GlRenderBackend glBackend;
+bool            boardLayerDirty = true;
+
+// The Draw* functions fill renderCommands, which is sorted and handed to
+// renderBackend at the end of the frame. --null-renderer swaps the GL backend for
+// the recorder, to time a frame's CPU work alone with --bench-frames, and
+// --command-log FILE also writes every frame's sorted commands as text, for
+// comparing the output of two renderer versions with diff.
+RenderCommandBuffer renderCommands;
+RenderRecorder      recorder;
+RenderBackend       renderBackend;
+bool                nullRenderer = false;
+std::string         commandLogFile;
+std::ofstream       commandLog;
+
+// linked programs are cached here between runs, --shader-cache DIR or --no-shader-cache
+std::string shaderCacheDir = DefaultShaderCacheDirectory();
+
+// per-frame instance data goes through a persistently mapped ring unless
+// --no-buffer-storage asks for the orphaning path
+const size_t STREAM_REGION_SIZE = 256 * 1024;  // bytes per frame, about 9000 quads
+bool         useBufferStorage   = true;
 
 // Function declarations
-void SpawnFruit();
+bool ParseArguments(int argc, char **argv);
+bool WaitForShaders(GLFWwindow *window);
 void InitGame();
-void ResetGame();
+int RunHeadless(GLFWwindow *window);
+int RunRenderBenchmark(GLFWwindow *window);
+bool CheckFrame(const std::string &name);
+bool LoadReplay(const std::string &path);
 void FramebufferSizeCallback(GLFWwindow *window, int width, int height);
+void WindowRefreshCallback(GLFWwindow *window);
 void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
-void DrawCell(const Vec2i &position, const Vec3 &color);
-void DrawChar(char c, float x, float y, float scale, const Vec3 &color);
-void DrawText(const std::string &text, float x, float y, float scale, const Vec3 &color);
+void ScrollCallback(GLFWwindow *window, double xoffset, double yoffset);
+void DrawText(std::string_view text, float x, float y, float scale, const Vec3 &color);
 void RenderGame(GLFWwindow *window);
-void UpdateGame(float deltaTime);
-void DrawBorder();
-void DrawSnake();
-void DrawScore();
-void DrawGameOver();
-void DrawStartScreen();
-
-auto main() -> int
+void RequestRedraw();
+void WakeRenderLoop();
+uint64_t NowNanoseconds();
+void PrintInputLatency();
+void ResetCamera();
+void UpdateCamera(const SimSnapshot &state);
+void Zoom(float factor);
+void DrawBorder(const CellRange &range);
+void InvalidateBoardLayer();
+void DrawSnake(const SimSnapshot &state);
+void DrawScore(const SimSnapshot &state);
+void DrawGameOver(const SimSnapshot &state);
+void DrawStartScreen(const SimSnapshot &state);
+void DrawProfilerHud();
+
+auto main(int argc, char **argv) -> int
 {
+    if (!ParseArguments(argc, argv)) {
+        return -1;
+    }
+
+    if (!replayPath.empty() && !LoadReplay(replayPath)) {
+        return -1;
+    }
+
+    // the null platform needs no display server, contexts come from OSMesa or EGL
+    if (headless) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
 #if defined(__linux__)
-    std::cout << "on linux" << "\n";
-    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_WAYLAND);
+    else if (std::getenv("WAYLAND_DISPLAY")) {
+        std::cout << "on linux" << "\n";
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_WAYLAND);
+    }
 #endif
 
     // init glfw
@@ -211,87 +251,69 @@ auto main() -> int
     glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
     glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
 
-    glfwSwapInterval(1);
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    }
+
     // setup window
     GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
+    if (!window && headless) {
+        // no OSMesa library, try a surfaceless EGL context instead
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
+    }
     if (!window) {
         std::cout << "Failed to create window" << "\n";
         glfwTerminate();
         return -1;
     }
 
+    // the swap interval and viewport apply to the current context, so make it current first
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(framePacer.Mode() == PacingMode::Vsync ? 1 : 0);
+
     glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
     glfwGetFramebufferSize(window, &gFbWidth, &gFbHeight);
     glViewport(0, 0, gFbWidth, gFbHeight);
 
-    glfwMakeContextCurrent(window);
     glfwSetKeyCallback(window, KeyCallback);
+    glfwSetScrollCallback(window, ScrollCallback);
+    glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
 
-    // setup glew
-    if (!glewInit() != GLEW_OK) {
+    // setup glew, which reports a missing GLX display on Wayland, EGL and OSMesa
+    // after it has already loaded the core entry points
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
         std::cout << "Failed to start GLEW" << "\n";
         glfwTerminate();
         return -1;
     }
 
-    // compile vertex shader
-    GLuint      vertexShader     = glCreateShader(GL_VERTEX_SHADER);
-    const char *vertexShaderCStr = vertexShaderSource.c_str();
-    glShaderSource(vertexShader, 1, &vertexShaderCStr, nullptr);
-    glCompileShader(vertexShader);
-
-    // check compilation
-    GLint  success;
-    GLchar infoLog[LOG_SIZE];
-
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, LOG_SIZE, nullptr, infoLog);
-        std::cerr << "ERROR:VERTEX_SHADER_COMPILATION_FAILED: " << infoLog << "\n";
-        glfwTerminate();
-        return -1;
-    }
-
-    // compile frag shader
-    GLuint      fragmentShader           = glCreateShader(GL_FRAGMENT_SHADER);
-    const char *fragmentShaderSourceCStr = fragmentShaderSource.c_str();
-    glShaderSource(fragmentShader, 1, &fragmentShaderSourceCStr, nullptr);
-    glCompileShader(fragmentShader);
-
-    // check compilation
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, LOG_SIZE, nullptr, infoLog);
-        std::cerr << "ERROR:VERTEX_FRAGMENT_COMPILATION_FAILED: " << infoLog << "\n";
-        glfwTerminate();
-        return -1;
+    // the null platform's default framebuffer cannot be read back reliably
+    if (headless) {
+        if (!offscreen.Init(gFbWidth, gFbHeight)) {
+            std::cout << "Failed to create offscreen framebuffer" << "\n";
+            glfwTerminate();
+            return -1;
+        }
+        offscreen.Bind();
     }
 
-    // create shader program
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    profiler.NameThread("main");
+    profiler.InitGpu();
 
-    // check linking
-    glGetShaderiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shaderProgram, LOG_SIZE, nullptr, infoLog);
-        std::cerr << "ERROR:SHADER_PROGRAM_LINKING_FAILED: " << infoLog << "\n";
+    // start compiling shaders, or load them from the cache; they are only waited
+    // for once the rest of the setup is done
+    auto shaderStart = std::chrono::steady_clock::now();
+    ShaderProgram::SetCacheDirectory(shaderCacheDir);
+    ShaderProgram::EnableParallelCompile();
+    if (!quadProgram.Compile(vertexShaderSource, fragmentShaderSource)) {
         glfwTerminate();
         return -1;
     }
 
-    // clean up shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // uniform locations
-    uOffsetLoc = glGetUniformLocation(shaderProgram, "uOffset");
-    uScaleLoc  = glGetUniformLocation(shaderProgram, "uScale");
-    uColorLoc  = glGetUniformLocation(shaderProgram, "uColor");
-
-    // setup VAO
+    // setup unit quad
     // clang-format off
 	const float vertices[] =
 	{
@@ -302,373 +324,851 @@ auto main() -> int
 	};
     // clang-format on
 
-    glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!streamBuffer.Init(STREAM_REGION_SIZE, useBufferStorage)) {
+        std::cout << "Failed to map the stream buffer" << "\n";
+        glfwTerminate();
+        return -1;
+    }
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
+    if (!textRenderer.Init(VBO)) {
+        glfwTerminate();
+        return -1;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glBackend.Init(VBO, &quadProgram, &streamBuffer, &textRenderer);
+    renderBackend = nullRenderer ? recorder.Backend() : glBackend.Backend();
+
+    if (!commandLogFile.empty()) {
+        commandLog.open(commandLogFile);
+        if (!commandLog) {
+            std::cout << "Failed to open " << commandLogFile << "\n";
+            glfwTerminate();
+            return -1;
+        }
+        recorder.SetSerialize(true);
+    }
 
     InitGame();
 
+    if (!WaitForShaders(window)) {
+        glfwTerminate();
+        return -1;
+    }
+    std::cout << "shaders ready in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - shaderStart).count() * 1000.0
+              << " ms" << (quadProgram.FromCache() ? " (cached)" : "") << "\n";
+
+    if (benchFrames > 0 || headless) {
+        int status = benchFrames > 0 ? RunRenderBenchmark(window) : RunHeadless(window);
+
+        profiler.DestroyGpu();
+        offscreen.Destroy();
+        glBackend.Destroy();
+        textRenderer.Destroy();
+        streamBuffer.Destroy();
+        glDeleteBuffers(1, &VBO);
+        quadProgram.Destroy();
+
+        glfwTerminate();
+        return status;
+    }
+
+    // frame statistics
+    long   frameCount       = 0;
+    long   totalDrawCalls   = 0;
+    long   totalInstances   = 0;
+    double totalFrameTime   = 0.0;
+    double totalUploadBytes = 0.0;
+    double totalStall       = 0.0;
+    double maxStall         = 0.0;
+
+    // ticks run on their own thread from here on
+    simulation.Launch(renderOnChange ? WakeRenderLoop : nullptr);
+
     // gameloop
-    auto lastTime = std::chrono::high_resolution_clock::now();
     while (!glfwWindowShouldClose(window)) {
-        // delta time
-        auto  currentTime = std::chrono::high_resolution_clock::now();
-        float deltaTime   = std::chrono::duration<float>(currentTime - lastTime).count();
-        lastTime          = currentTime;
+        // input, either blocking until something happens or polling every frame
+        if (renderOnChange) {
+            PROFILE_SCOPE("WaitForEvents");
+            glfwWaitEvents();
+        } else {
+            PROFILE_SCOPE("PollEvents");
+            glfwPollEvents();
+        }
 
-        // input
-        glfwPollEvents();
+        profiler.BeginFrame();
+        auto currentTime = std::chrono::steady_clock::now();
+
+        // pick up the newest tick, never waits for the simulation
+        if (simulation.Snapshots().Acquire()) {
+            RequestRedraw();
+        }
 
-        // update game state
-        UpdateGame(deltaTime);
+        // nothing changed on screen since the last swap
+        if (renderOnChange && !frameDirty) {
+            continue;
+        }
+        frameDirty = false;
 
         // render
+        AllocationScope allocations;
+        renderStats = RenderStats();
         RenderGame(window);
+        frameAllocations += allocations.Allocations();
+        allocatingFrames += allocations.Allocations() > 0;
+
+        frameCount++;
+        totalDrawCalls += renderStats.drawCalls;
+        totalInstances += renderStats.instances;
+        totalFrameTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - currentTime).count();
+        totalUploadBytes += renderStats.uploadBytes;
+        totalStall += renderStats.uploadStall;
+        maxStall = std::max(maxStall, renderStats.uploadStall);
+
+        lastFrameStats = renderStats;
+        profiler.Counter("draw calls", renderStats.drawCalls);
+        profiler.Counter("instances", renderStats.instances);
+        profiler.Counter("uniform uploads", renderStats.uniformUploads);
+        profiler.Counter("upload bytes", renderStats.uploadBytes);
+        profiler.Counter("upload stall us", static_cast<uint64_t>(renderStats.uploadStall * 1e6));
+        profiler.Counter("heap allocations", allocations.Allocations());
+        profiler.EndFrame();
+
+        // wait for the next frame slot, a no-op for vsync and uncapped
+        {
+            PROFILE_SCOPE("FramePacer");
+            framePacer.EndFrame();
+        }
+    }
+
+    simulation.Stop();
+
+    if (frameCount > 0) {
+        std::cout << "frames: " << frameCount << ", avg frame: " << totalFrameTime * 1000.0 / frameCount << " ms"
+                  << ", draw calls/frame: " << static_cast<double>(totalDrawCalls) / frameCount
+                  << ", quads/frame: " << static_cast<double>(totalInstances) / frameCount << "\n";
+        std::cout << "ticks: " << simulation.Ticks() << ", dropped ticks: " << simulation.DroppedTicks()
+                  << ", late avg: " << simulation.AverageLateness() * 1000.0
+                  << " ms, max: " << simulation.MaxLateness() * 1000.0 << " ms" << "\n";
+        std::cout << "uploads: " << (streamBuffer.Persistent() ? "persistent" : "orphaned")
+                  << ", avg: " << totalUploadBytes / 1024.0 / frameCount << " KB/frame"
+                  << ", stall avg: " << totalStall * 1000.0 / frameCount << " ms, max: " << maxStall * 1000.0
+                  << " ms" << "\n";
+        std::cout << "heap allocations: " << frameAllocations << " in " << allocatingFrames << " of " << frameCount
+                  << " frames, frame arena high water: " << frameArena.HighWater() << " bytes" << "\n";
+    }
+
+    PrintInputLatency();
+
+    const FramePacingStats &pacing = framePacer.Stats();
+    if (pacing.frames > 0) {
+        std::cout << "pacing: " << FramePacer::ModeName(framePacer.Mode())
+                  << ", interval avg: " << pacing.meanInterval * 1000.0 << " ms"
+                  << ", jitter: " << pacing.jitter * 1000.0 << " ms"
+                  << ", min/max: " << pacing.minInterval * 1000.0 << "/" << pacing.maxInterval * 1000.0 << " ms"
+                  << ", slept: " << pacing.sleepTime << " s, spun: " << pacing.spinTime << " s" << "\n";
+    }
+
+    if (!traceFile.empty() && profiler.WriteChromeTrace(traceFile)) {
+        std::cout << "trace written to " << traceFile << "\n";
     }
 
     // clean up
-    glDeleteVertexArrays(1, &VAO);
+    profiler.DestroyGpu();
+    glBackend.Destroy();
+    textRenderer.Destroy();
+    streamBuffer.Destroy();
     glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram);
+    quadProgram.Destroy();
 
     glfwTerminate();
     return 0;
 }
 
-void UpdateGame(float deltaTime)
+// --vsync (default), --fps N or --uncapped, plus --on-change and the profiling flags
+bool ParseArguments(int argc, char **argv)
 {
-    if (gameStarted && !gameOver) {
-        // update game timer
-        timeSinceLastUpdate += deltaTime;
-
-        // update game
-        if (timeSinceLastUpdate >= snakeSpeed) {
-            timeSinceLastUpdate = 0.0f;
-
-            // move snake
-            Vec2i newHead = snake[0];
-
-            switch (snakeDir) {
-                case Direction::Up:
-                    newHead.y++;
-                    break;
-                case Direction::Down:
-                    newHead.y--;
-                    break;
-                case Direction::Right:
-                    newHead.x++;
-                    break;
-                case Direction::Left:
-                    newHead.x--;
-                    break;
-                case Direction::None:
-                    return;
-            }
-
-            // wall collision
-            if (newHead.x < 0 || newHead.x >= GRID_WIDTH || newHead.y < 0 || newHead.y >= GRID_HEIGHT) {
-                gameOver = true;
-                return;
-            }
-            // self collision
-            for (const auto &segment : snake) {
-                if (newHead == segment) {
-                    gameOver = true;
-                    return;
-                }
+    framePacer.Configure(PacingMode::Vsync);
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--vsync")) {
+            framePacer.Configure(PacingMode::Vsync);
+        } else if (!std::strcmp(argv[i], "--fps") && i + 1 < argc) {
+            framePacer.Configure(PacingMode::TargetFps, std::atof(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--uncapped")) {
+            framePacer.Configure(PacingMode::Uncapped);
+        } else if (!std::strcmp(argv[i], "--on-change")) {
+            renderOnChange = true;
+        } else if (!std::strcmp(argv[i], "--profile")) {
+            profiler.SetEnabled(true);
+        } else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc) {
+            profiler.SetEnabled(true);
+            traceFile = argv[++i];
+        } else if (!std::strcmp(argv[i], "--hud")) {
+            profiler.SetEnabled(true);
+            showProfilerHud = true;
+        } else if (!std::strcmp(argv[i], "--record") && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (!std::strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--autopilot")) {
+            autopilot = true;
+        } else if (!std::strcmp(argv[i], "--grid") && i + 1 < argc) {
+            // WxH, or a single number for a square board
+            int parsed = std::sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight);
+            if (parsed == 1) {
+                gridHeight = gridWidth;
             }
-
-            // add head
-            snake.insert(snake.begin(), newHead);
-
-            // fruit collision
-            if (newHead == fruit) {
-                score += 10;
-                SpawnFruit();
-
-                // speed increase every 5 fruits
-                if (score % 50 == 0 && snakeSpeed > 0.05f) {
-                    snakeSpeed -= 0.01f;
-                }
-            } else {
-                // pop tail
-                snake.pop_back();
+            if (parsed < 1 || std::min(gridWidth, gridHeight) < MIN_GRID_SIZE
+                || std::max(gridWidth, gridHeight) > MAX_GRID_SIZE) {
+                std::cout << "--grid must be between " << MIN_GRID_SIZE << " and " << MAX_GRID_SIZE
+                          << " cells per side" << "\n";
+                return false;
             }
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            fixedSeed = true;
+            gameSeed  = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--shader-cache") && i + 1 < argc) {
+            shaderCacheDir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--no-shader-cache")) {
+            shaderCacheDir.clear();
+        } else if (!std::strcmp(argv[i], "--input-depth") && i + 1 < argc) {
+            simulation.Input().SetDepth(std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--no-buffer-storage")) {
+            useBufferStorage = false;
+        } else if (!std::strcmp(argv[i], "--headless")) {
+            headless = true;
+        } else if (!std::strcmp(argv[i], "--capture") && i + 1 < argc) {
+            captureDir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--golden") && i + 1 < argc) {
+            goldenDir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--update-golden")) {
+            updateGolden = true;
+        } else if (!std::strcmp(argv[i], "--bench-frames") && i + 1 < argc) {
+            benchFrames = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--null-renderer")) {
+            nullRenderer = true;
+        } else if (!std::strcmp(argv[i], "--command-log") && i + 1 < argc) {
+            commandLogFile = argv[++i];
+        } else {
+            std::cout << "usage: " << argv[0]
+                      << " [--vsync | --fps N | --uncapped] [--on-change] [--profile] [--trace FILE] [--hud]"
+                      << " [--grid WxH] [--input-depth N] [--record FILE | --replay FILE] [--seed N] [--autopilot]"
+                      << " [--shader-cache DIR | --no-shader-cache] [--no-buffer-storage]"
+                      << " [--headless [--capture DIR] [--golden DIR [--update-golden]]]"
+                      << " [--bench-frames N [--null-renderer]] [--command-log FILE]" << "\n";
+            return false;
         }
     }
-}
 
-void RenderGame(GLFWwindow *window)
-{
-    glClearColor(0.08f, 0.1f, 0.12f, 1.0f);  // dark blue bg
-    glClear(GL_COLOR_BUFFER_BIT);
+    // the benchmark measures rendering, not the display's refresh rate
+    if (benchFrames > 0) {
+        framePacer.Configure(PacingMode::Uncapped);
+    }
 
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
+    // headless sessions must look the same on every run
+    if (headless && !fixedSeed) {
+        fixedSeed = true;
+        gameSeed  = 1;
+    }
+    if (nullRenderer && benchFrames == 0) {
+        std::cout << "--null-renderer needs --bench-frames N" << "\n";
+        return false;
+    }
+    if (updateGolden && goldenDir.empty()) {
+        std::cout << "--update-golden needs --golden DIR" << "\n";
+        return false;
+    }
+    return true;
+}
 
-    // draw border
-    DrawBorder();
+uint64_t NowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
 
-    if (!gameStarted) {
-        DrawStartScreen();
-    } else if (gameOver) {
-        DrawGameOver();
-    } else {
-        DrawSnake();
-        DrawScore();
-    }
+void RequestRedraw()
+{
+    frameDirty = true;
+}
 
-    glBindVertexArray(0);
+// called on the simulation thread after it publishes, glfwPostEmptyEvent is the
+// one GLFW call that may come from any thread
+void WakeRenderLoop()
+{
+    glfwPostEmptyEvent();
+}
 
-    glfwSwapBuffers(window);
+// shows the whole board when it is small, otherwise the default zoom
+void ResetCamera()
+{
+    viewCells = std::min(DEFAULT_VIEW_CELLS, static_cast<float>(std::max(gridWidth, gridHeight)));
+    InvalidateBoardLayer();
 }
 
-void DrawCell(const Vec2i &position, const Vec3 &color)
+// centres the view on the head, clamped so it stops at the border, and works out
+// which cells are visible
+void UpdateCamera(const SimSnapshot &state)
 {
-    Vec2 offset(-1.0f + position.x * CELL_WIDTH + CELL_WIDTH * 0.5f,
-                -1.0f + position.y * CELL_HEIGHT + CELL_HEIGHT * 0.5f);
+    float aspect = static_cast<float>(gFbWidth) / std::max(gFbHeight, 1);
+    viewWidth    = aspect >= 1.0f ? viewCells * aspect : viewCells;
+    viewHeight   = aspect >= 1.0f ? viewCells : viewCells / aspect;
 
-    // apply scalling to fit cell, slightly smaller for grid effect
-    Vec2 scale(CELL_WIDTH * 0.9f, CELL_HEIGHT * 0.9f);
+    Vec2 head = InterpolatedSegment(state, 0, tickAlpha);
 
-    // draw
-    glUniform3f(uColorLoc, color.r, color.g, color.b);
-    glUniform2f(uOffsetLoc, offset.x, offset.y);
-    glUniform2f(uScaleLoc, scale.x, scale.y);
+    auto follow = [](float target, float view, int size) {
+        if (size <= view) {
+            return size * 0.5f;
+        }
+        return std::clamp(target, view * 0.5f - 1.0f, size + 1.0f - view * 0.5f);
+    };
+    cameraX = follow(head.x + 0.5f, viewWidth, gridWidth);
+    cameraY = follow(head.y + 0.5f, viewHeight, gridHeight);
+
+    // one extra cell on each side for quads that straddle the edge
+    visibleCells.minX = std::max(static_cast<int>(std::floor(cameraX - viewWidth * 0.5f)) - 1, -1);
+    visibleCells.minY = std::max(static_cast<int>(std::floor(cameraY - viewHeight * 0.5f)) - 1, -1);
+    visibleCells.maxX = std::min(static_cast<int>(std::ceil(cameraX + viewWidth * 0.5f)), gridWidth);
+    visibleCells.maxY = std::min(static_cast<int>(std::ceil(cameraY + viewHeight * 0.5f)), gridHeight);
+}
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+// factor below 1 zooms in
+void Zoom(float factor)
+{
+    float widest = std::min(MAX_VIEW_CELLS, static_cast<float>(std::max(gridWidth, gridHeight) + 2));
+    viewCells    = std::clamp(viewCells * factor, std::min(MIN_VIEW_CELLS, widest), widest);
+    InvalidateBoardLayer();
+    RequestRedraw();
 }
 
-void DrawChar(char c, float x, float y, float scale, const Vec3 &color)
+void RenderGame(GLFWwindow *window)
 {
-    // convert to uppercase
-    c = std::toupper(c);
+    PROFILE_SCOPE("RenderGame");
+
+    frameArena.Reset();
+
+    // the newest snapshot the frame loop has acquired, the simulation may already
+    // be filling the next one
+    const SimSnapshot &state = simulation.Snapshots().Front();
+
+    // how far the clock has moved on from the tick shown; interpolating needs a
+    // redraw every frame, so render-on-change shows the latest tick as is
+    double sinceTick = (simulation.Clock() - state.tickTime) / state.tickInterval;
+    tickAlpha        = renderOnChange ? 1.0f : std::clamp(static_cast<float>(sinceTick), 0.0f, 1.0f);
+
+    renderCommands.Reset();
+    renderCommands.AddClear(Vec3(0.08f, 0.1f, 0.12f));  // dark blue bg
+
+    UpdateCamera(state);
+    renderCommands.SetView(
+        -cameraX * 2.0f / viewWidth, -cameraY * 2.0f / viewHeight, 2.0f / viewWidth, 2.0f / viewHeight);
+
+    // border and checkerboard are retained and cover more than the view, they are
+    // rebuilt after invalidation or once the camera moves past what they cover
+    bool covered = visibleCells.minX >= boardLayerCells.minX && visibleCells.maxX <= boardLayerCells.maxX
+                && visibleCells.minY >= boardLayerCells.minY && visibleCells.maxY <= boardLayerCells.maxY;
+    bool rebuild = boardLayerDirty || !covered;
+
+    size_t boardFirst = renderCommands.Quads().size();
+    if (rebuild) {
+        int margin           = static_cast<int>(viewCells / 2.0f) + 1;
+        boardLayerCells.minX = std::max(visibleCells.minX - margin, -1);
+        boardLayerCells.minY = std::max(visibleCells.minY - margin, -1);
+        boardLayerCells.maxX = std::min(visibleCells.maxX + margin, gridWidth);
+        boardLayerCells.maxY = std::min(visibleCells.maxY + margin, gridHeight);
+
+        DrawBorder(boardLayerCells);
+        boardLayerDirty = false;
+    }
+    renderCommands.AddRetainedQuads(RenderLayer::Board, boardFirst, rebuild);
 
-    // search for char in font map
-    auto it = fontMap.find(c);
-    if (it == fontMap.end()) {
-        // default to space if not found
-        it = fontMap.find(' ');
+    if (state.screen == SimScreen::Start) {
+        DrawStartScreen(state);
+    } else if (state.screen == SimScreen::GameOver) {
+        DrawGameOver(state);
+    } else {
+        DrawSnake(state);
+        DrawScore(state);
     }
 
-    const std::vector<int> &bitmap = it->second;
+    if (showProfilerHud) {
+        DrawProfilerHud();
+    }
 
-    // draw each pixel of the char
-    float charWidth  = FONT_WIDTH * scale;
-    float charHeight = FONT_HEIGHT * scale;
+    // cells over the board and text over the cells, however they were added
+    renderCommands.Sort();
+    renderBackend.Execute(renderCommands);
 
-    for (int i = 0; i < FONT_HEIGHT; i++) {
-        for (int j = 0; j < FONT_WIDTH; j++) {
-            if (bitmap[i * FONT_WIDTH + j]) {
-                Vec2 offset(x + j * scale - charWidth / 2.0f, y - i * scale + charHeight / 2.0f);
+    if (commandLog.is_open()) {
+        if (!nullRenderer) {
+            recorder.Execute(renderCommands);
+        }
+        commandLog << recorder.Log();
+        recorder.ClearLog();
+    }
 
-                glUniform3f(uColorLoc, color.r, color.g, color.b);
-                glUniform2f(uOffsetLoc, offset.x, offset.y);
-                glUniform2f(uScaleLoc, scale, scale);
+    // nothing reached GL, report what would have
+    if (nullRenderer) {
+        const RecordedStats &recorded = recorder.LastFrame();
+        renderStats.drawCalls += static_cast<int>(recorded.drawCalls);
+        renderStats.instances += static_cast<int>(recorded.quads + recorded.glyphs);
+    }
 
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            }
-        }
+    // headless frames stay in the offscreen target until they are read back
+    if (!headless) {
+        PROFILE_SCOPE("SwapBuffers");
+        glfwSwapBuffers(window);
     }
+
+    // every turn applied up to the tick shown is on screen now
+    uint64_t presented = NowNanoseconds();
+    uint64_t history   = std::min<uint64_t>(state.turns, SimSnapshot::TURN_HISTORY);
+    for (uint64_t turn = std::max(presentedTurns, state.turns - history); turn < state.turns; turn++) {
+        uint64_t inputTime = state.turnTimes[turn % SimSnapshot::TURN_HISTORY];
+        lastTurnLatency    = (presented - inputTime) / 1e9;
+        turnLatencies[latencyCount++ % LATENCY_SAMPLES] = lastTurnLatency;
+        profiler.Counter("input latency us", (presented - inputTime) / 1000);
+    }
+    presentedTurns = std::max(presentedTurns, state.turns);
 }
 
-void DrawText(const std::string &text, float x, float y, float scale, const Vec3 &color)
+void DrawText(std::string_view text, float x, float y, float scale, const Vec3 &color)
 {
-    float charWidth  = FONT_WIDTH * scale;
-    float spacing    = FONT_SPACING * scale;
-    float totalWidth = text.size() * (charWidth + spacing) - spacing;
+    renderCommands.AddText(text, x, y, scale, color);
+}
 
-    float startX = x - totalWidth / 2.0f;
+// adds the part of the border and checkerboard inside range, for RenderGame to
+// replace the retained board layer with
+void DrawBorder(const CellRange &range)
+{
+    PROFILE_SCOPE("DrawBorder");
 
-    for (size_t i = 0; i < text.size(); i++) {
-        DrawChar(text[i], startX + i * (charWidth + spacing), y, scale, color);
-    }
+    AppendBoardQuads(range, gridWidth, gridHeight, renderCommands.Quads());
 }
 
-void DrawBorder()
+void DrawSnake(const SimSnapshot &state)
 {
-    Vec3 borderColor(0.3f, 0.3f, 0.5f);
+    PROFILE_SCOPE("DrawSnake");
 
-    // top border
-    for (int x = -1; x <= GRID_WIDTH; x++) {
-        DrawCell(Vec2i(x, GRID_HEIGHT), borderColor);
-    }
+    size_t first = renderCommands.Quads().size();
+    AppendSnakeQuads(state, visibleCells, tickAlpha, renderCommands.Quads());
+    renderCommands.AddQuads(RenderLayer::Cells, first);
+}
 
-    // bottom border
-    for (int x = -1; x <= GRID_HEIGHT; x++) {
-        DrawCell(Vec2i(x, -1), borderColor);
-    }
+void DrawScore(const SimSnapshot &state)
+{
+    PROFILE_SCOPE("DrawScore");
+
+    DrawText(frameArena.Format("SCORE: %d", state.score), 0.0f, 0.9f, 0.02f, Vec3(0.9f, 0.9f, 0.9f));
+}
+
+void DrawGameOver(const SimSnapshot &state)
+{
+    PROFILE_SCOPE("DrawGameOver");
+
+    size_t first = renderCommands.Quads().size();
+    AppendGameOverQuads(visibleCells, gridWidth, gridHeight, renderCommands.Quads());
+    renderCommands.AddQuads(RenderLayer::Cells, first);
 
-    // right border
-    for (int y = -1; y <= GRID_HEIGHT; y++) {
-        DrawCell(Vec2i(-1, y), borderColor);
+    if (state.gameWon) {
+        DrawText("YOU WIN", 0.0f, 0.1f, 0.03f, Vec3(0.2f, 0.8f, 0.3f));
+    } else {
+        DrawText("GAME OVER", 0.0f, 0.1f, 0.03f, Vec3(1.0f, 0.3f, 0.3f));
     }
+    DrawText(frameArena.Format("SCORE: %d", state.score), 0.0f, -0.05f, 0.02f, Vec3(1.0f, 1.0f, 1.0f));
+    DrawText("PRESS R TO RESTART", 0.0f, -0.2f, 0.015f, Vec3(0.8f, 0.8f, 0.8f));
+}
+
+void DrawStartScreen(const SimSnapshot &state)
+{
+    PROFILE_SCOPE("DrawStartScreen");
+
+    DrawSnake(state);
+
+    DrawText("CHAD SNAKE", 0.0f, 0.3f, 0.025f, Vec3(0.2f, 0.8f, 0.3f));
+
+    DrawText("USE ARROW KEYS TO MOVE", 0.0f, 0.0f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
+    DrawText("EAT THE RED FRUIT TO GROW", 0.0f, -0.1f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
+    DrawText("AVOID WALLS AND YOURSELF", 0.0f, -0.2f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
+    DrawText("PRESS ANY KEY TO START", 0.0f, -0.4f, 0.012f, Vec3(0.8f, 0.8f, 0.2f));
+}
 
-    // left border
-    for (int y = -1; y <= GRID_HEIGHT; y++) {
-        DrawCell(Vec2i(GRID_WIDTH, y), borderColor);
+// press-to-present latency of the turns played, the last LATENCY_SAMPLES of them
+void PrintInputLatency()
+{
+    size_t samples = static_cast<size_t>(std::min<uint64_t>(latencyCount, LATENCY_SAMPLES));
+    if (samples == 0) {
+        return;
     }
 
-    // draw grid lines
-    Vec3 gridColor(0.15f, 0.17f, 0.2f);
-    for (int x = 0; x < GRID_WIDTH; x++) {
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            if ((x + y) % 2 == 0) {
-                DrawCell(Vec2i(x, y), gridColor);
-            }
-        }
+    std::sort(turnLatencies.begin(), turnLatencies.begin() + samples);
+    auto percentile = [samples](double p) { return turnLatencies[static_cast<size_t>(p * (samples - 1))]; };
+
+    double sum = 0.0;
+    for (size_t i = 0; i < samples; i++) {
+        sum += turnLatencies[i];
     }
+
+    std::cout << "input: " << latencyCount << " turns, depth " << simulation.Input().Depth()
+              << ", dropped presses: " << droppedPresses << ", latency avg: " << sum * 1000.0 / samples
+              << " ms, p50: " << percentile(0.5) * 1000.0 << " ms, p95: " << percentile(0.95) * 1000.0
+              << " ms, max: " << turnLatencies[samples - 1] * 1000.0 << " ms" << "\n";
 }
 
-void DrawSnake()
+// rolling frame-time percentiles and last frame's counters along the bottom edge
+void DrawProfilerHud()
 {
-    Vec3 headColor(0.0f, 0.95f, 0.3f);
-    Vec3 bodyColor(0.0f, 0.7f, 0.1f);
+    // refreshed a few times a second, so the cached text meshes are not rebuilt every frame
+    double now = glfwGetTime();
+    if (now >= hudNextUpdate) {
+        hudNextUpdate = now + 0.25;
+
+        FrameTimePercentiles frameTimes = profiler.FramePercentiles();
+        std::snprintf(hudLines[0],
+                      sizeof(hudLines[0]),
+                      "FRAME P50 %.2f P95 %.2f P99 %.2f MAX %.2f MS",
+                      frameTimes.p50,
+                      frameTimes.p95,
+                      frameTimes.p99,
+                      frameTimes.max);
+        std::snprintf(hudLines[1],
+                      sizeof(hudLines[1]),
+                      "CPU %.2f MS  GPU %.2f MS  INPUT %.2f MS",
+                      profiler.AverageCpuTime(),
+                      profiler.GpuFrameTime(),
+                      lastTurnLatency * 1000.0);
+        std::snprintf(hudLines[2],
+                      sizeof(hudLines[2]),
+                      "DRAWS %d  QUADS %d  UNIFORMS %d  STALL %.2f MS",
+                      lastFrameStats.drawCalls,
+                      lastFrameStats.instances,
+                      lastFrameStats.uniformUploads,
+                      lastFrameStats.uploadStall * 1000.0);
+    }
 
-    // draw body
-    for (size_t i = 1; i < snake.size(); i++) {
-        float factor = static_cast<float>(i) / snake.size();
-        Vec3  segmentColor(bodyColor.r * (1.0f - factor) + 0.1f * factor,
-                          bodyColor.g * (1.0f - factor) + 0.8f * factor,
-                          bodyColor.b * (1.0f - factor));
+    Vec3 hudColor(1.0f, 0.85f, 0.3f);
+    DrawText(hudLines[0], 0.0f, -0.89f, 0.006f, hudColor);
+    DrawText(hudLines[1], 0.0f, -0.93f, 0.006f, hudColor);
+    DrawText(hudLines[2], 0.0f, -0.97f, 0.006f, hudColor);
+}
 
-        DrawCell(snake[i], segmentColor);
+// Presents cleared frames until the programs have linked, so the window shows
+// up straight away while a software rasterizer is still compiling
+bool WaitForShaders(GLFWwindow *window)
+{
+    while (!headless && !(quadProgram.Ready() && textRenderer.Ready()) && !glfwWindowShouldClose(window)) {
+        glClearColor(0.08f, 0.1f, 0.12f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
     }
 
-    // draw head
-    DrawCell(snake[0], headColor);
-
-    // draw fruit
-    DrawCell(fruit, Vec3(1.0f, 0.3f, 0.3f));  // red
+    return quadProgram.Finish() && textRenderer.Finish();
 }
 
-void DrawScore()
+void InitGame()
 {
-    std::string scoreText = "SCORE: " + std::to_string(score);
-    DrawText(scoreText, 0.0f, 0.9f, 0.02f, Vec3(0.9f, 0.9f, 0.9f));
+    SimConfig config;
+    config.width      = gridWidth;
+    config.height     = gridHeight;
+    config.fixedSeed  = fixedSeed;
+    config.seed       = gameSeed;
+    config.recordFile = recordFile;
+    config.autopilot  = autopilot;
+    if (replayEvents) {
+        config.replayHeader = &replayHeader;
+        config.replayEvents = replayEvents;
+    }
+    simulation.Configure(config);
+    simulation.Snapshots().Acquire();
+
+    ResetCamera();
 }
 
-void DrawGameOver()
+// Scripted session: start screen, a frame shortly into the game and the first
+// game-over frame. Without --replay the snake runs straight into the right wall.
+// In-game frames after the captured one must not allocate, except within a few
+// ticks of the snake growing longer than it has been, while the buffers that hold
+// it (one per snapshot slot) catch up.
+int RunHeadless(GLFWwindow *window)
 {
-    for (int x = 0; x < GRID_WIDTH; x++) {
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            DrawCell(Vec2i(x, y), Vec3(0.2f, 0.1f, 0.1f));
+    bool     passed            = true;
+    uint64_t steadyAllocations = 0;
+    int      steadyFrames      = 0;
+    size_t   longestSnake      = 0;
+    uint64_t grewAtTick        = 0;
+
+    RenderGame(window);
+    passed &= CheckFrame("start");
+
+    simulation.RequestStart();
+
+    bool capturedIngame = false;
+    for (int frame = 1; frame <= HEADLESS_MAX_FRAMES; frame++) {
+        AllocationScope allocations;
+        simulation.Advance(HEADLESS_FRAME_TIME);
+        simulation.Snapshots().Acquire();
+        RenderGame(window);
+
+        const SimSnapshot &state = simulation.Snapshots().Front();
+        if (state.screen == SimScreen::GameOver) {
+            if (!capturedIngame) {
+                std::cout << "Game ended before frame " << HEADLESS_INGAME_FRAME << "\n";
+                passed = false;
+            }
+            passed &= CheckFrame("gameover");
+            std::cout << "headless: " << frame << " frames, " << state.tick << " ticks, score " << state.score << "\n";
+            std::cout << "heap allocations: " << steadyAllocations << " in " << steadyFrames << " steady in-game frames"
+                      << "\n";
+            if (steadyAllocations > 0) {
+                std::cout << "In-game frames allocated" << "\n";
+                passed = false;
+            }
+            return passed ? 0 : 1;
+        }
+
+        if (state.snake.Size() > longestSnake) {
+            longestSnake = state.snake.Size();
+            grewAtTick   = state.tick;
+        }
+        if (capturedIngame && state.tick >= grewAtTick + HEADLESS_GROWTH_TICKS) {
+            steadyAllocations += allocations.Allocations();
+            steadyFrames++;
+        }
+
+        if (frame == HEADLESS_INGAME_FRAME) {
+            passed &= CheckFrame("ingame");
+            capturedIngame = true;
+        }
+
+        // an unfinished replay never reaches game over
+        if (state.replayEnded) {
+            std::cout << "Replay ended without a game over" << "\n";
+            return 1;
         }
     }
 
-    DrawText("GAME OVER", 0.0f, 0.1f, 0.03f, Vec3(1.0f, 0.3f, 0.3f));
-    DrawText("SCORE: " + std::to_string(score), 0.0f, -0.05f, 0.02f, Vec3(1.0f, 1.0f, 1.0f));
-    DrawText("PRESS R TO RESTART", 0.0f, -0.2f, 0.015f, Vec3(0.8f, 0.8f, 0.8f));
+    std::cout << "No game over after " << HEADLESS_MAX_FRAMES << " frames" << "\n";
+    return 1;
 }
 
-void DrawStartScreen()
+// renders benchFrames in-game frames back to back, restarting whenever the game ends
+int RunRenderBenchmark(GLFWwindow *window)
 {
-    DrawSnake();
+    std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n";
+
+    simulation.RequestStart();
+
+    long   totalDrawCalls = 0;
+    long   totalInstances = 0;
+    double totalStall     = 0.0;
+    auto   start          = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < benchFrames; frame++) {
+        profiler.BeginFrame();
+
+        simulation.Advance(HEADLESS_FRAME_TIME);
+        simulation.Snapshots().Acquire();
+        if (simulation.Snapshots().Front().screen == SimScreen::GameOver) {
+            simulation.RequestReset();
+            simulation.RequestStart();
+            simulation.Advance(0.0);
+            simulation.Snapshots().Acquire();
+        }
 
-    DrawText("CHAD SNAKE", 0.0f, 0.3f, 0.025f, Vec3(0.2f, 0.8f, 0.3f));
+        AllocationScope allocations;
+        renderStats = RenderStats();
+        RenderGame(window);
+        frameAllocations += allocations.Allocations();
+        allocatingFrames += allocations.Allocations() > 0;
+        totalDrawCalls += renderStats.drawCalls;
+        totalInstances += renderStats.instances;
+        totalStall += renderStats.uploadStall;
 
-    DrawText("USE ARROW KEYS TO MOVE", 0.0f, 0.0f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
-    DrawText("EAT THE RED FRUIT TO GROW", 0.0f, -0.1f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
-    DrawText("AVOID WALLS AND YOURSELF", 0.0f, -0.2f, 0.012f, Vec3(0.9f, 0.9f, 0.9f));
-    DrawText("PRESS ANY KEY TO START", 0.0f, -0.4f, 0.012f, Vec3(0.8f, 0.8f, 0.2f));
+        profiler.EndFrame();
+    }
+
+    // the time only counts once the GPU, or the software rasterizer, has caught up
+    glFinish();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "bench: " << benchFrames << " frames in " << elapsed << " s, " << elapsed * 1000.0 / benchFrames
+              << " ms/frame, " << benchFrames / elapsed << " fps"
+              << ", draw calls/frame: " << static_cast<double>(totalDrawCalls) / benchFrames
+              << ", quads/frame: " << static_cast<double>(totalInstances) / benchFrames << "\n";
+    std::cout << "uploads: " << (streamBuffer.Persistent() ? "persistent" : "orphaned")
+              << ", stall: " << totalStall * 1000.0 / benchFrames << " ms/frame" << "\n";
+    std::cout << "heap allocations while drawing: " << frameAllocations << " in " << allocatingFrames << " of "
+              << benchFrames << " frames" << "\n";
+
+    if (!traceFile.empty() && profiler.WriteChromeTrace(traceFile)) {
+        std::cout << "trace written to " << traceFile << "\n";
+    }
+    return 0;
 }
 
-void SpawnFruit()
+// writes and/or compares the frame just rendered, false on a golden mismatch
+bool CheckFrame(const std::string &name)
 {
-    static std::random_device       rd;
-    static std::mt19937             gen(rd());
-    std::uniform_int_distribution<> distX(0, GRID_WIDTH - 1);
-    std::uniform_int_distribution<> distY(0, GRID_HEIGHT - 1);
-
-    while (1) {
-        Vec2i newFruit(distX(gen), distY(gen));
-
-        bool validPosition = true;
-        for (const auto &segment : snake) {
-            if (segment == newFruit) {
-                validPosition = false;
-                break;
-            }
-        }
+    Image frame;
+    offscreen.Read(frame);
+
+    if (!captureDir.empty() && !WritePng(captureDir + "/" + name + ".png", frame)) {
+        std::cout << "Failed to write " << captureDir << "/" << name << ".png" << "\n";
+    }
 
-        if (validPosition) {
-            fruit = newFruit;
-            break;
+    if (goldenDir.empty()) {
+        return true;
+    }
+
+    std::string goldenPath = goldenDir + "/" + name + ".png";
+    if (updateGolden) {
+        if (!WritePng(goldenPath, frame)) {
+            std::cout << "Failed to write " << goldenPath << "\n";
+            return false;
         }
+        std::cout << "updated " << goldenPath << "\n";
+        return true;
+    }
+
+    Image golden;
+    if (!ReadPng(goldenPath, golden)) {
+        std::cout << "Failed to read " << goldenPath << "\n";
+        return false;
+    }
+
+    Image     diffImage;
+    ImageDiff diff    = CompareImages(frame, golden, GOLDEN_TOLERANCE, &diffImage);
+    size_t    allowed = static_cast<size_t>(GOLDEN_MAX_DIFFERING * frame.width * frame.height);
+    if (diff.differingPixels > allowed) {
+        std::string diffPath = (captureDir.empty() ? goldenDir : captureDir) + "/" + name + "-diff.png";
+        WritePng(diffPath, diffImage);
+        std::cout << name << ": " << diff.differingPixels << " pixels differ (max delta " << diff.maxDelta
+                  << "), see " << diffPath << "\n";
+        return false;
     }
+
+    std::cout << name << ": ok" << "\n";
+    return true;
 }
 
-void InitGame()
+bool LoadReplay(const std::string &path)
 {
-    ResetGame();
-    SpawnFruit();
+    if (!replayFile.Open(path)) {
+        std::cout << "Failed to open replay " << path << "\n";
+        return false;
+    }
+
+    ReplayReader reader(replayFile.Data(), replayFile.Size());
+    if (!reader.Next(replayHeader, replayEvents)) {
+        std::cout << "No valid replay in " << path << "\n";
+        return false;
+    }
+
+    // the replay's board size wins over --grid, the reader has checked it is supported
+    gridWidth  = replayHeader.width;
+    gridHeight = replayHeader.height;
+    return true;
 }
 
-void ResetGame()
+// call whenever the grid size or framebuffer changes
+void InvalidateBoardLayer()
 {
-    snake               = {Vec2i(5, 10), Vec2i(4, 10), Vec2i(3, 10)};
-    snakeDir            = Direction::None;
-    gameOver            = false;
-    gameStarted         = false;
-    score               = 0;
-    timeSinceLastUpdate = 0.0f;
-    snakeSpeed          = UPDATE_INTERVAL;
+    boardLayerDirty = true;
 }
 
 void FramebufferSizeCallback(GLFWwindow *window, int width, int height)
 {
+    gFbWidth  = width;
+    gFbHeight = height;
     glViewport(0, 0, width, height);
+    InvalidateBoardLayer();
+    RequestRedraw();
+}
+
+// the window was exposed or damaged and its contents must be drawn again
+void WindowRefreshCallback(GLFWwindow *window)
+{
+    RequestRedraw();
 }
 
 void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+    // profiler overlay, works on every screen
+    if (action == GLFW_PRESS && key == GLFW_KEY_F3) {
+        showProfilerHud = !showProfilerHud;
+        profiler.SetEnabled(profiler.Enabled() || showProfilerHud);
+        RequestRedraw();
+        return;
+    }
+
+    // zoom, also works on every screen and repeats while held
+    if (action != GLFW_RELEASE) {
+        if (key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD) {
+            Zoom(1.0f / ZOOM_STEP);
+            return;
+        }
+        if (key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT) {
+            Zoom(ZOOM_STEP);
+            return;
+        }
+    }
+
+    // the screen as last published; the simulation ignores requests that no
+    // longer apply by the time it sees them
+    SimScreen screen = simulation.Snapshots().Front().screen;
+    bool      replay = replayEvents != nullptr;
+
     if (action == GLFW_PRESS) {
-        if (!gameStarted && key != GLFW_KEY_R) {
-            gameStarted = true;
-            snakeDir    = Direction::Right;
+        if (screen == SimScreen::Start && key != GLFW_KEY_R) {
+            simulation.RequestStart();
             return;
         }
     }
 
-    if (gameOver && key == GLFW_KEY_R) {
-        ResetGame();
-        SpawnFruit();
+    if ((screen == SimScreen::GameOver || replay) && key == GLFW_KEY_R) {
+        simulation.RequestReset();
         return;
     }
 
-    if (!gameOver && gameStarted) {
+    // turns are validated against the heading when a tick pops them
+    if (action == GLFW_PRESS && screen == SimScreen::Playing && !replay && !autopilot) {
+        InputEvent event;
+        event.time = NowNanoseconds();
         switch (key) {
-            case GLFW_KEY_UP: {
-                if (snakeDir != Direction::Down) {
-                    snakeDir = Direction::Up;
-                }
-            } break;
-            case GLFW_KEY_DOWN: {
-                if (snakeDir != Direction::Up) {
-                    snakeDir = Direction::Down;
-                }
-            } break;
-            case GLFW_KEY_LEFT: {
-                if (snakeDir != Direction::Right) {
-                    snakeDir = Direction::Left;
-                }
-            } break;
-            case GLFW_KEY_RIGHT: {
-                if (snakeDir != Direction::Left) {
-                    snakeDir = Direction::Right;
-                }
-            } break;
-            default:
+            case GLFW_KEY_UP:
+                event.direction = Direction::Up;
+                break;
+            case GLFW_KEY_DOWN:
+                event.direction = Direction::Down;
+                break;
+            case GLFW_KEY_LEFT:
+                event.direction = Direction::Left;
                 break;
+            case GLFW_KEY_RIGHT:
+                event.direction = Direction::Right;
+                break;
+            default:
+                return;
         }
+
+        if (!simulation.Input().Push(event)) {
+            droppedPresses++;
+        }
+    }
+}
+
+void ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    if (yoffset > 0.0) {
+        Zoom(1.0f / ZOOM_STEP);
+    } else if (yoffset < 0.0) {
+        Zoom(ZOOM_STEP);
     }
 }
@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstring>
+
+#include "quadBatch.h"
+#include "streamBuffer.h"
+
+// offsets stay aligned for any attribute type
+const size_t WRITE_ALIGNMENT = 16;
+
+bool StreamBuffer::Init(size_t initialRegionSize, bool allowPersistent)
+{
+    persistent = allowPersistent && GLEW_ARB_buffer_storage;
+    Allocate(initialRegionSize);
+    return buffer != 0 && (!persistent || mapped);
+}
+
+void StreamBuffer::Destroy()
+{
+    Release();
+}
+
+void StreamBuffer::BeginFrame()
+{
+    cursor = 0;
+
+    if (!persistent) {
+        // orphan, the driver hands out fresh storage if the old one is still in use
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    region = (region + 1) % FRAME_REGIONS;
+
+    GLsync fence = fences[region];
+    if (!fence) {
+        return;
+    }
+
+    // the first check is free when the GPU is FRAME_REGIONS - 1 frames behind or less
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1 ms
+        } while (status == GL_TIMEOUT_EXPIRED);
+        renderStats.uploadStall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    glDeleteSync(fence);
+    fences[region] = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (persistent && cursor > 0) {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+size_t StreamBuffer::Write(const void *data, size_t bytes)
+{
+    size_t offset = (cursor + WRITE_ALIGNMENT - 1) & ~(WRITE_ALIGNMENT - 1);
+
+    // out of room: a bigger buffer, draws already issued keep reading the old one
+    if (offset + bytes > regionSize) {
+        size_t newRegionSize = regionSize * 2;
+        while (newRegionSize < bytes) {
+            newRegionSize *= 2;
+        }
+        Release();
+        Allocate(newRegionSize);
+        if (!persistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        offset = 0;
+    }
+
+    size_t bufferOffset = offset;
+    if (persistent) {
+        bufferOffset += region * regionSize;
+        std::memcpy(mapped + bufferOffset, data, bytes);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, data);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    cursor = offset + bytes;
+    renderStats.uploadBytes += static_cast<int>(bytes);
+    return bufferOffset;
+}
+
+void StreamBuffer::Allocate(size_t newRegionSize)
+{
+    regionSize = newRegionSize;
+    cursor     = 0;
+    region     = 0;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionSize * FRAME_REGIONS, nullptr, flags);
+        mapped = static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * FRAME_REGIONS, flags));
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StreamBuffer::Release()
+{
+    for (GLsync &fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (mapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        mapped = nullptr;
+    }
+
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
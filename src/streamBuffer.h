@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+// Streams per-frame data (instance attributes) through one buffer object.
+//
+// With GL_ARB_buffer_storage the buffer is allocated once, mapped persistently and
+// coherently, and split into FRAME_REGIONS regions used round robin. A fence is
+// placed after the last draw reading a region, and a frame only waits on it when
+// it comes back to that region, FRAME_REGIONS - 1 frames later, by which time the
+// GPU has normally long finished. Without the extension every frame orphans the
+// buffer with glBufferData(NULL) and writes with glBufferSubData, leaving the
+// renaming to the driver.
+class StreamBuffer
+{
+public:
+    static constexpr int FRAME_REGIONS = 3;
+
+    // regionSize is the budget per frame in bytes, frames that need more grow the buffer
+    bool Init(size_t regionSize, bool allowPersistent = true);
+    void Destroy();
+
+    // waits for this frame's region to be free, the wait is added to renderStats.uploadStall
+    void BeginFrame();
+
+    // fences the region, call after the last draw that reads this frame's data
+    void EndFrame();
+
+    // copies data into the current region and returns its offset in Buffer()
+    size_t Write(const void *data, size_t bytes);
+
+    GLuint Buffer() const { return buffer; }
+
+    bool Persistent() const { return mapped != nullptr; }
+
+private:
+    void Allocate(size_t newRegionSize);
+    void Release();
+
+    GLuint buffer     = 0;
+    char  *mapped     = nullptr;
+    bool   persistent = false;
+    size_t regionSize = 0;
+    size_t cursor     = 0;  // next free byte in the current region
+    int    region     = 0;
+
+    GLsync fences[FRAME_REGIONS] = {};  // set by EndFrame, waited on by BeginFrame
+};
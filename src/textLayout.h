@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "core/vec.h"
+
+const int FONT_WIDTH   = 5;
+const int FONT_HEIGHT  = 5;
+const int FONT_SPACING = 1;
+const int GLYPH_COUNT  = 128;
+
+// One lit glyph, laid out to match the text program's per-instance attributes
+struct GlyphInstance
+{
+    Vec2     center;
+    float    scale;
+    unsigned glyph;
+    Vec3     color;
+};
+
+// The 5x5 glyph of character c as a 25-bit mask, bit (row * 5 + col) with row 0
+// at the top; 0 for blanks and characters the font does not have. Lower case
+// is not folded here, LayoutText() does that.
+unsigned GlyphMask(unsigned char c);
+
+// Appends an instance per visible glyph of text, centered on x, at the layout
+// DrawText has always used. No GL involved, so it can be timed on its own.
+void LayoutText(std::string_view text,
+                float x,
+                float y,
+                float scale,
+                const Vec3 &color,
+                std::vector<GlyphInstance> &out);
@@ -0,0 +1,176 @@
+#include "quadBatch.h"
+#include "textRenderer.h"
+
+// Text shader sources
+static const std::string textVertexShaderSource = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aCenter;
+    layout (location = 2) in float aScale;
+    layout (location = 3) in uint aGlyph;
+    layout (location = 4) in vec3 aColor;
+    uniform usamplerBuffer uGlyphs;
+    out vec2 vCell;
+    out vec3 vColor;
+    flat out uint vMask;
+
+    void main() {
+        vec2 position = aCenter + aPos * (5.0 * aScale);
+        gl_Position = vec4(position, 0.0, 1.0);
+        vCell = (aPos + 0.5) * 5.0;
+        vColor = aColor;
+        vMask = texelFetch(uGlyphs, int(aGlyph)).r;
+    }
+)";
+
+static const std::string textFragmentShaderSource = R"(
+    #version 330 core
+    in vec2 vCell;
+    in vec3 vColor;
+    flat in uint vMask;
+    out vec4 FragColor;
+
+    void main() {
+        // bit (row * 5 + col), row 0 is the top of the glyph
+        int col = clamp(int(vCell.x), 0, 4);
+        int row = 4 - clamp(int(vCell.y), 0, 4);
+        if (((vMask >> uint(row * 5 + col)) & 1u) == 0u) {
+            discard;
+        }
+        FragColor = vec4(vColor, 1.0);
+    }
+)";
+
+bool TextRenderer::Init(GLuint quadVertexBuffer)
+{
+    quadVBO = quadVertexBuffer;
+
+    if (!program.Compile(textVertexShaderSource, textFragmentShaderSource)) {
+        return false;
+    }
+
+    // every glyph, unknown characters stay blank
+    unsigned masks[GLYPH_COUNT];
+    for (int c = 0; c < GLYPH_COUNT; c++) {
+        masks[c] = GlyphMask(static_cast<unsigned char>(c));
+    }
+
+    glGenBuffers(1, &glyphBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, glyphBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(masks), masks, GL_STATIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glGenTextures(1, &glyphTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, glyphTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, glyphBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    return true;
+}
+
+bool TextRenderer::Finish()
+{
+    if (!program.Finish()) {
+        return false;
+    }
+
+    program.Use();
+    glUniform1i(program.Uniform("uGlyphs"), 0);
+    renderStats.uniformUploads++;
+    glUseProgram(0);
+
+    return true;
+}
+
+void TextRenderer::Destroy()
+{
+    for (auto &[key, mesh] : meshes) {
+        glDeleteVertexArrays(1, &mesh.vao);
+        glDeleteBuffers(1, &mesh.instanceVBO);
+    }
+    meshes.clear();
+    pending.clear();
+
+    glDeleteTextures(1, &glyphTexture);
+    glDeleteBuffers(1, &glyphBuffer);
+    program.Destroy();
+}
+
+void TextRenderer::Draw(std::string_view text, float x, float y, float scale, const Vec3 &color)
+{
+    TextMesh &mesh = meshes[SlotKey(x, y, scale)];
+
+    // rebuild only when the slot shows something new
+    bool sameColor = mesh.color.r == color.r && mesh.color.g == color.g && mesh.color.b == color.b;
+    if (!mesh.vao || mesh.text != text || !sameColor) {
+        Build(mesh, text, x, y, scale, color);
+    }
+
+    if (mesh.instanceCount > 0) {
+        pending.push_back(&mesh);
+    }
+}
+
+void TextRenderer::Flush()
+{
+    if (pending.empty()) {
+        return;
+    }
+
+    program.Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, glyphTexture);
+
+    for (const TextMesh *mesh : pending) {
+        glBindVertexArray(mesh->vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, mesh->instanceCount);
+
+        renderStats.drawCalls++;
+        renderStats.instances += mesh->instanceCount;
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    pending.clear();
+}
+
+void TextRenderer::Build(TextMesh &mesh, std::string_view text, float x, float y, float scale, const Vec3 &color)
+{
+    if (!mesh.vao) {
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.instanceVBO);
+
+        glBindVertexArray(mesh.vao);
+
+        // shared unit quad
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+
+        // one instance per visible glyph
+        const GLsizei stride = sizeof(GlyphInstance);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceVBO);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(GlyphInstance, center));
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(GlyphInstance, scale));
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, stride, (void *)offsetof(GlyphInstance, glyph));
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(GlyphInstance, color));
+
+        for (GLuint attrib = 1; attrib <= 4; attrib++) {
+            glEnableVertexAttribArray(attrib);
+            glVertexAttribDivisor(attrib, 1);
+        }
+
+        glBindVertexArray(0);
+    }
+
+    mesh.text  = text;
+    mesh.color = color;
+
+    scratch.clear();
+    LayoutText(text, x, y, scale, color, scratch);
+
+    mesh.instanceCount = static_cast<GLsizei>(scratch.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, scratch.size() * sizeof(GlyphInstance), scratch.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "core/vec.h"
+#include "shader.h"
+#include "textLayout.h"
+
+// Draws bitmap text with one instanced call per string. The 5x5 glyphs are packed
+// into 25-bit masks in a buffer texture and expanded in the fragment shader.
+//
+// Built instance data is cached per (position, scale) slot and only re-uploaded
+// when the string or color drawn in that slot changes, so static labels cost no
+// CPU work after the first frame.
+class TextRenderer
+{
+public:
+    // starts the shader compile, Finish() must succeed before the first Flush()
+    bool Init(GLuint quadVBO);
+    bool Ready() const { return program.Ready(); }
+    bool Finish();
+    void Destroy();
+
+    // queues a string centered on x, drawn on the next flush
+    void Draw(std::string_view text, float x, float y, float scale, const Vec3 &color);
+    void Flush();
+
+private:
+    struct TextMesh
+    {
+        std::string text;
+        Vec3        color;
+        GLuint      vao           = 0;
+        GLuint      instanceVBO   = 0;
+        GLsizei     instanceCount = 0;
+    };
+
+    using SlotKey = std::tuple<float, float, float>;
+
+    void Build(TextMesh &mesh, std::string_view text, float x, float y, float scale, const Vec3 &color);
+
+    ShaderProgram program;
+    GLuint        glyphBuffer  = 0;
+    GLuint        glyphTexture = 0;
+    GLuint        quadVBO      = 0;
+
+    std::map<SlotKey, TextMesh>   meshes;
+    std::vector<const TextMesh *> pending;
+    std::vector<GlyphInstance>    scratch;
+};
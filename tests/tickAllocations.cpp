@@ -0,0 +1,71 @@
+// Checks that Step() does not touch the heap once the snake has room for its
+// length. Autopilot games are played to the end, each Step() is wrapped in an
+// AllocationScope, and only the ticks on which the snake grew longer than it has
+// been may allocate, while its ring catches up; the headless game run checks the
+// same for whole frames.
+#include <cstdint>
+#include <iostream>
+
+#include "core/allocationTracker.h"
+#include "core/autopilot.h"
+#include "core/batchSim.h"
+#include "core/gameState.h"
+
+const int      GRID_SIDES[] = {GRID_WIDTH, 16};
+const uint64_t GAMES        = 4;
+const uint64_t SEED         = 1;
+
+struct TickCounts
+{
+    uint64_t ticks             = 0;
+    uint64_t growthTicks       = 0;
+    uint64_t steadyAllocations = 0;
+};
+
+static void PlayGame(int side, uint64_t seed, Autopilot &autopilot, TickCounts &counts)
+{
+    GameState state(side, side);
+    ResetGame(state, seed);
+    autopilot.Reset();
+    state.snakeDir = Direction::Right;  // as when the player starts the game
+
+    // a won game fills the board in well under cells squared ticks
+    uint64_t maxTicks = static_cast<uint64_t>(side) * side * side * side;
+    size_t   longest  = state.snake.Size();
+    while (!state.gameOver && state.tick < maxTicks) {
+        Direction decision = autopilot.Decide(state);
+
+        AllocationScope allocations;
+        Step(state, decision);
+        uint64_t made = allocations.Allocations();
+
+        counts.ticks++;
+        if (state.snake.Size() > longest) {
+            longest = state.snake.Size();
+            counts.growthTicks++;
+        } else {
+            counts.steadyAllocations += made;
+        }
+    }
+}
+
+auto main() -> int
+{
+    bool passed = true;
+    for (int side : GRID_SIDES) {
+        Autopilot  autopilot(side, side);
+        TickCounts counts;
+        for (uint64_t game = 0; game < GAMES; game++) {
+            PlayGame(side, BatchSim::EpisodeSeed(SEED, game, 0), autopilot, counts);
+        }
+
+        std::cout << side << "x" << side << ": " << counts.ticks << " ticks, " << counts.growthTicks
+                  << " growing, heap allocations in the others: " << counts.steadyAllocations << "\n";
+        passed &= counts.steadyAllocations == 0;
+    }
+
+    if (!passed) {
+        std::cout << "Steady ticks allocated" << "\n";
+    }
+    return passed ? 0 : 1;
+}
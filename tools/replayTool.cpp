@@ -0,0 +1,187 @@
+// Scans replay archives: re-simulates every record headless and reports games
+// whose replayed outcome no longer matches what was recorded, or just summarizes
+// the headers. Can also generate archives of bot games for testing.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/gameState.h"
+#include "core/mappedFile.h"
+#include "core/replay.h"
+#include "core/rng.h"
+
+static void PrintUsage(const char *program)
+{
+    std::cout << "usage: " << program << " [--headers] FILE...\n"
+              << "       " << program << " --generate COUNT OUT [--seed N]\n";
+}
+
+// greedy bot with some noise: heads for the fruit, avoids walls and the body
+static Direction ChooseInput(const GameState &state, Rng &rng)
+{
+    const Direction options[] = {Direction::Up, Direction::Down, Direction::Left, Direction::Right};
+
+    Direction best     = Direction::None;
+    int       bestCost = INT32_MAX;
+    for (Direction option : options) {
+        // the reverse is rejected by ApplyInput anyway
+        if (state.snakeDir != Direction::None && option == Reverse(state.snakeDir)) {
+            continue;
+        }
+        if (Blocked(state, option)) {
+            continue;
+        }
+
+        Vec2i next = Neighbour(state.snake.Head(), option);
+        int   cost = std::abs(next.x - state.fruit.x) + std::abs(next.y - state.fruit.y)
+            + static_cast<int>(rng.NextBelow(4));
+        if (cost < bestCost) {
+            bestCost = cost;
+            best     = option;
+        }
+    }
+    return best == state.snakeDir ? Direction::None : best;
+}
+
+static int Generate(size_t count, const std::string &path, uint64_t seed)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "Failed to open " << path << "\n";
+        return 1;
+    }
+
+    Rng rng;
+    rng.Seed(seed, 7);
+
+    GameState            state;
+    ReplayRecorder       recorder;
+    std::vector<uint8_t> bytes;
+    uint64_t             totalTicks = 0;
+
+    for (size_t game = 0; game < count; game++) {
+        uint64_t gameSeed = (static_cast<uint64_t>(rng.Next()) << 32) | rng.Next();
+        ResetGame(state, gameSeed);
+        recorder.Begin(gameSeed, state);
+
+        state.snakeDir = Direction::Right;
+        recorder.SetStartDirection(Direction::Right);
+
+        while (!state.gameOver) {
+            Direction input = ChooseInput(state, rng);
+            recorder.Record(state.tick, input);
+            Step(state, input);
+        }
+        totalTicks += state.tick;
+
+        bytes.clear();
+        recorder.Finish(state, bytes);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::cout << "wrote " << count << " games, " << totalTicks << " ticks, to " << path << " ("
+              << static_cast<long long>(file.tellp()) << " bytes)" << "\n";
+    return file ? 0 : 1;
+}
+
+struct ScanTotals
+{
+    size_t   records    = 0;
+    size_t   mismatches = 0;
+    size_t   malformed  = 0;
+    uint64_t ticks      = 0;
+    uint64_t scoreSum   = 0;
+    uint32_t scoreMax   = 0;
+};
+
+static bool Scan(const std::string &path, bool headersOnly, ScanTotals &totals)
+{
+    MappedFile file;
+    if (!file.Open(path)) {
+        std::cout << path << ": cannot open" << "\n";
+        return false;
+    }
+
+    ReplayReader   reader(file.Data(), file.Size());
+    ReplayHeader   header;
+    const uint8_t *events = nullptr;
+    size_t         index  = 0;
+
+    while (reader.Next(header, events)) {
+        totals.records++;
+        totals.ticks += header.tickCount;
+        totals.scoreSum += header.finalScore;
+        totals.scoreMax = std::max(totals.scoreMax, header.finalScore);
+
+        if (!headersOnly) {
+            GameState state(header.width, header.height);
+            bool      decoded = PlayReplay(header, events, state);
+            if (!decoded) {
+                totals.malformed++;
+                std::cout << path << " #" << index << ": malformed events" << "\n";
+            } else if (!ReplayMatches(header, state)) {
+                totals.mismatches++;
+                std::cout << path << " #" << index << ": recorded score " << header.finalScore << " at tick "
+                          << header.tickCount << ", replayed " << state.score << " at tick " << state.tick << "\n";
+            }
+        }
+        index++;
+    }
+
+    if (reader.Error()) {
+        totals.malformed++;
+        std::cout << path << ": malformed record at byte " << reader.Offset() << "\n";
+    }
+    return true;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!std::strcmp(argv[1], "--generate")) {
+        if (argc != 4 && argc != 6) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        uint64_t seed = argc == 6 && !std::strcmp(argv[4], "--seed") ? std::strtoull(argv[5], nullptr, 10) : 1;
+        return Generate(std::strtoull(argv[2], nullptr, 10), argv[3], seed);
+    }
+
+    bool                     headersOnly = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--headers")) {
+            headersOnly = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    ScanTotals totals;
+    auto       start = std::chrono::steady_clock::now();
+    for (const std::string &path : paths) {
+        Scan(path, headersOnly, totals);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "records: " << totals.records << ", ticks: " << totals.ticks
+              << ", avg score: " << (totals.records ? static_cast<double>(totals.scoreSum) / totals.records : 0.0)
+              << ", max score: " << totals.scoreMax << "\n";
+    if (!headersOnly) {
+        // real time at the starting tick interval, later ticks are faster
+        std::cout << "mismatches: " << totals.mismatches << ", malformed: " << totals.malformed << ", "
+                  << totals.ticks / seconds / 1e6 << " M ticks/s, "
+                  << totals.ticks * UPDATE_INTERVAL / seconds << "x real time" << "\n";
+    }
+    return totals.mismatches == 0 && totals.malformed == 0 ? 0 : 1;
+}